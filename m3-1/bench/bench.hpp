@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "graph.hpp"
+
+using namespace std;
+
+// Measurement drivers behind the performance changes. Each builds its input from a fixed seed, so
+// runs on one machine compare across commits; they take no files and print one line per case.
+// Drivers that check a result instead of timing it exit with 1 when it is wrong.
+int benchEdgeIndex(int argc, char **argv);
+int benchListCopy(int argc, char **argv);
+int benchCompressed(int argc, char **argv);
+int benchBinaryRoundTrip(int argc, char **argv);
+int benchReorder(int argc, char **argv);
+int benchSnapshots(int argc, char **argv);
+
+using ArcList = vector<tuple<vertex_t, vertex_t, weight_t>>;
+
+inline double millisecondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Graph over vertices labelled 0 .. vertices - 1 holding `edges`, finalized
+inline Graph buildGraph(bool directed, bool weighted, RepresentationType representation, int vertices, const ArcList &edges,
+                        bool indexEdges = false)
+{
+    Graph graph(directed, weighted, representation, indexEdges);
+    graph.reserve(vertices, (int)edges.size());
+    for (int v = 0; v < vertices; ++v)
+        graph.addVertex(to_string(v));
+    graph.addEdges(edges);
+    graph.finalize();
+    return graph;
+}
+
+// Directed weighted flow network where the first `hubs` vertices have an arc to and from every other
+// vertex, plus `extra` random arcs among the rest: rows of degree ~V next to rows of degree ~extra / V
+inline ArcList hubEdges(int vertices, int hubs, int extra)
+{
+    mt19937 rng(3);
+    uniform_int_distribution<int> weight(1, 9), other(hubs, vertices - 1);
+    ArcList edges;
+    for (int hub = 0; hub < hubs; ++hub)
+    {
+        for (int v = hubs; v < vertices; ++v)
+        {
+            edges.emplace_back(hub, v, weight(rng));
+            edges.emplace_back(v, hub, weight(rng));
+        }
+    }
+    for (int i = 0; i < extra; ++i)
+    {
+        int u = other(rng), v = other(rng);
+        if (u != v)
+            edges.emplace_back(u, v, weight(rng));
+    }
+    return edges;
+}
+
+// Edges of an undirected test graph, returning its vertex count: "web" links mostly to nearby ids as
+// crawl-ordered pages do, "grid" is a 1000 x 1000 lattice and "social" a preferential-attachment graph,
+// both with shuffled ids
+inline int testGraphEdges(const string &kind, ArcList &edges)
+{
+    mt19937 rng(11);
+    uniform_int_distribution<int> weight(1, 9);
+    auto shuffleIds = [&](int n)
+    {
+        vector<int> id(n);
+        iota(id.begin(), id.end(), 0);
+        shuffle(id.begin(), id.end(), rng);
+        for (auto &[u, v, w] : edges)
+        {
+            u = id[u];
+            v = id[v];
+        }
+    };
+
+    if (kind == "grid")
+    {
+        const int side = 1000;
+        for (int y = 0; y < side; ++y)
+        {
+            for (int x = 0; x < side; ++x)
+            {
+                int v = y * side + x;
+                if (x + 1 < side)
+                    edges.emplace_back(v, v + 1, weight(rng));
+                if (y + 1 < side)
+                    edges.emplace_back(v, v + side, weight(rng));
+            }
+        }
+        shuffleIds(side * side);
+        return side * side;
+    }
+    if (kind == "social")
+    {
+        const int n = 500000;
+        vector<int> endpoints;
+        for (int v = 1; v < n; ++v)
+        {
+            for (int k = 0; k < 8; ++k)
+            {
+                int u = endpoints.empty() || rng() % 4 == 0 ? rng() % v : endpoints[rng() % endpoints.size()];
+                edges.emplace_back(v, u, weight(rng));
+                endpoints.push_back(u);
+                endpoints.push_back(v);
+            }
+        }
+        shuffleIds(n);
+        return n;
+    }
+    const int n = 2000000;
+    exponential_distribution<double> distance(0.05);
+    for (int v = 0; v < n; ++v)
+    {
+        for (int k = 0; k < 8; ++k)
+        {
+            int u = v;
+            if (rng() % 10 == 0)
+                u = rng() % n;
+            else
+            {
+                int d = 1 + (int)distance(rng);
+                u = rng() % 2 ? v + d : v - d;
+            }
+            if (u >= 0 && u < n)
+                edges.emplace_back(v, u, weight(rng));
+        }
+    }
+    return n;
+}
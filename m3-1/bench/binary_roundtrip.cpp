@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "bench.hpp"
+#include "utils.hpp"
+
+// Every stored arc as {source, destination, weight}, sorted
+static ArcList storedArcs(const Graph &graph)
+{
+    ArcList arcs;
+    for (int u = 0; u < graph.getVertexCount(); ++u)
+    {
+        for (const Edge &e : graph.neighbors(u))
+            arcs.emplace_back(u, e.destination, e.weight);
+    }
+    sort(arcs.begin(), arcs.end());
+    return arcs;
+}
+
+// saveBinary() followed by loading the file keeps every arc, including zero and negative
+// weights, from and into each weighted representation. Returns 1 on the first mismatch.
+int benchBinaryRoundTrip(int, char **)
+{
+    const int vertices = 200;
+    mt19937 rng(23);
+    uniform_int_distribution<int> weight(-3, 3);
+    ArcList edges;
+    for (int u = 0; u < vertices; ++u)
+    {
+        for (int v = u + 1; v < vertices; ++v)
+        {
+            if (rng() % 16 == 0)
+                edges.emplace_back(rng() % 2 ? u : v, rng() % 2 ? v : u, weight(rng));
+        }
+    }
+    string filename = (filesystem::temp_directory_path() / "graph_roundtrip.bin").string();
+    const pair<RepresentationType, const char *> types[] = {
+        {RepresentationType::LIST, "LIST"}, {RepresentationType::MATRIX, "MATRIX"}, {RepresentationType::CSR, "CSR"},
+        {RepresentationType::COMPRESSED, "COMPRESSED"}, {RepresentationType::HYBRID, "HYBRID"}};
+
+    int checked = 0;
+    for (bool directed : {true, false})
+    {
+        for (const auto &[from, fromName] : types)
+        {
+            Graph graph = buildGraph(directed, true, from, vertices, edges);
+            // A matrix cannot hold zero weights, so it only contributes the arcs it stored
+            ArcList expected = storedArcs(graph);
+            if (!graph.saveBinary(filename))
+            {
+                fprintf(stderr, "cannot write %s\n", filename.c_str());
+                return 1;
+            }
+            for (const auto &[to, toName] : types)
+            {
+                if (to == RepresentationType::MATRIX)
+                    continue;
+                Graph *loaded = loadGraphFromFile(filename, to);
+                bool same = loaded && loaded->isDirected() == directed && storedArcs(*loaded) == expected;
+                delete loaded;
+                if (!same)
+                {
+                    fprintf(stderr, "round trip lost arcs: %s %s graph saved, loaded as %s\n",
+                            directed ? "directed" : "undirected", fromName, toName);
+                    filesystem::remove(filename);
+                    return 1;
+                }
+                ++checked;
+            }
+        }
+    }
+    filesystem::remove(filename);
+    printf("%d round trips kept every arc of %zu edges with weights in [-3, 3]\n", checked, edges.size());
+    return 0;
+}
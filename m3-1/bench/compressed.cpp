@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "bench.hpp"
+#include "basic_graph.hpp"
+
+// Sum of the vertex ids in visiting order, so both representations must traverse alike to agree
+template <typename View>
+static unsigned long breadthFirst(const View &graph)
+{
+    int n = graph.getVertexCount();
+    vector<char> seen(n, 0);
+    vector<int> queue;
+    queue.reserve(n);
+    unsigned long checksum = 0;
+    for (int root = 0; root < n; ++root)
+    {
+        if (seen[root])
+            continue;
+        seen[root] = 1;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int v = queue[head];
+            checksum += v * head;
+            graph.forEachNeighbor(v, [&](int w, weight_t)
+                                  {
+                if (!seen[w])
+                {
+                    seen[w] = 1;
+                    queue.push_back(w);
+                } });
+        }
+    }
+    return checksum;
+}
+
+template <typename View>
+static unsigned long depthFirst(const View &graph)
+{
+    int n = graph.getVertexCount();
+    vector<char> seen(n, 0);
+    vector<int> stack;
+    unsigned long checksum = 0, order = 0;
+    for (int root = 0; root < n; ++root)
+    {
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            stack.pop_back();
+            if (seen[v])
+                continue;
+            seen[v] = 1;
+            checksum += v * order++;
+            graph.forEachNeighbor(v, [&](int w, weight_t)
+                                  {
+                if (!seen[w])
+                    stack.push_back(w); });
+        }
+    }
+    return checksum;
+}
+
+// Size and traversal speed of COMPRESSED against CSR, with file order and BFS-reordered ids
+int benchCompressed(int argc, char **argv)
+{
+    string kind = argc > 1 ? argv[1] : "web";
+    bool weighted = argc > 2 && strcmp(argv[2], "weighted") == 0;
+    ArcList edges;
+    int vertices = testGraphEdges(kind, edges);
+
+    for (bool reordered : {false, true})
+    {
+        size_t csrBytes = 0;
+        double csrBfs = 0, csrDfs = 0;
+        for (RepresentationType type : {RepresentationType::CSR, RepresentationType::COMPRESSED})
+        {
+            Graph graph = buildGraph(false, weighted, type, vertices, edges);
+            if (reordered)
+                graph.reorder(ReorderStrategy::BFS);
+            MemoryFootprint footprint = graph.memoryFootprint();
+            size_t bytes = footprint.structure + footprint.weights;
+
+            // Best of three
+            double bfs = 1e18, dfs = 1e18;
+            unsigned long checksum = 0;
+            for (int run = 0; run < 3; ++run)
+            {
+                auto start = chrono::steady_clock::now();
+                checksum += visitGraph(graph, [](const auto &view)
+                                       { return breadthFirst(view); });
+                bfs = min(bfs, millisecondsSince(start));
+                start = chrono::steady_clock::now();
+                checksum += visitGraph(graph, [](const auto &view)
+                                       { return depthFirst(view); });
+                dfs = min(dfs, millisecondsSince(start));
+            }
+
+            bool csr = type == RepresentationType::CSR;
+            if (csr)
+            {
+                csrBytes = bytes;
+                csrBfs = bfs;
+                csrDfs = dfs;
+            }
+            printf("%-6s %-4s %-10s %8.1f MiB (%.2fx smaller) | bfs %7.1f ms (%.2fx CSR) | dfs %7.1f ms (%.2fx CSR) | check %lu\n",
+                   kind.c_str(), reordered ? "BFS" : "file", csr ? "CSR" : "COMPRESSED", bytes / 1048576.0,
+                   (double)csrBytes / bytes, bfs, bfs / csrBfs, dfs, dfs / csrDfs, checksum);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include <cstdio>
+
+#include "bench.hpp"
+
+// Edge lookups on a LIST graph whose hub rows hold thousands of edges, scanned (plain) or
+// answered by the per-row hash index (indexed)
+int benchEdgeIndex(int, char **)
+{
+    const int vertices = 3000, hubs = 10;
+    ArcList edges = hubEdges(vertices, hubs, 20000);
+    uniform_int_distribution<int> any(0, vertices - 1);
+
+    for (bool indexed : {false, true})
+    {
+        mt19937 rng(4);
+        Graph graph = buildGraph(true, true, RepresentationType::LIST, vertices, edges, indexed);
+
+        // Every stored arc, then as many random pairs, most of which are absent
+        auto start = chrono::steady_clock::now();
+        double found = 0;
+        for (const auto &[u, v, w] : edges)
+            found += graph.edgeWeight(u, v);
+        long present = 0;
+        for (size_t i = 0; i < edges.size(); ++i)
+            present += graph.edgeExists(any(rng), any(rng));
+        double lookup = millisecondsSince(start);
+
+        // Residual updates as an augmenting path makes them: down along the arc, back up again
+        start = chrono::steady_clock::now();
+        for (const auto &[u, v, w] : edges)
+        {
+            graph.addFlow(u, v, -1);
+            graph.addFlow(u, v, 1);
+        }
+        double flow = millisecondsSince(start);
+
+        printf("%-8s %zu arcs | lookups %8.1f ms | addFlow %8.1f ms | check %.0f %ld\n", indexed ? "indexed" : "plain",
+               edges.size(), lookup, flow, found, present);
+    }
+    return 0;
+}
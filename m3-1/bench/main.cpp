@@ -0,0 +1,33 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.hpp"
+
+struct Driver
+{
+    const char *name;
+    int (*run)(int argc, char **argv);
+    const char *measures;
+};
+
+static const Driver drivers[] = {
+    {"edge-index", benchEdgeIndex, "LIST edge lookups on hub rows, with and without INDEXED"},
+    {"list-copy", benchListCopy, "allocations and time of copying and destroying a LIST graph"},
+    {"compressed", benchCompressed, "[web|grid|social] [weighted]: COMPRESSED against CSR, size and traversals"},
+    {"roundtrip", benchBinaryRoundTrip, "check that binary save and load keep zero and negative weights"},
+    {"reorder", benchReorder, "[grid|social] [CSR|LIST]: traversals before and after reorder(RCM|BFS|DEGREE)"},
+    {"snapshots", benchSnapshots, "[LIST|HYBRID|CSR]: check concurrent pins against a publishing writer"},
+};
+
+int main(int argc, char **argv)
+{
+    for (const Driver &driver : drivers)
+    {
+        if (argc > 1 && strcmp(argv[1], driver.name) == 0)
+            return driver.run(argc - 1, argv + 1);
+    }
+    fprintf(stderr, "Usage: %s <driver> [args]\n", argv[0]);
+    for (const Driver &driver : drivers)
+        fprintf(stderr, "  %-12s %s\n", driver.name, driver.measures);
+    return 1;
+}
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstring>
+#include <queue>
+
+#include "bench.hpp"
+#include "coloring_algorithms.hpp"
+
+// Sum of the vertex ids in visiting order over every component, through the generic neighbors() range
+static unsigned long breadthFirst(const Graph &graph)
+{
+    int n = graph.getVertexCount();
+    vector<char> seen(n, 0);
+    vector<int> queue;
+    queue.reserve(n);
+    unsigned long checksum = 0;
+    for (int root = 0; root < n; ++root)
+    {
+        if (seen[root])
+            continue;
+        seen[root] = 1;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int v = queue[head];
+            checksum += v * head;
+            for (const Edge &e : graph.neighbors(v))
+            {
+                if (!seen[e.destination])
+                {
+                    seen[e.destination] = 1;
+                    queue.push_back(e.destination);
+                }
+            }
+        }
+    }
+    return checksum;
+}
+
+// Sum of the shortest distances from `source`, which does not depend on the numbering
+static double shortestDistances(const Graph &graph, int source)
+{
+    vector<double> dist(graph.getVertexCount(), -1);
+    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> queue;
+    dist[source] = 0;
+    queue.push({0, source});
+    while (!queue.empty())
+    {
+        auto [d, u] = queue.top();
+        queue.pop();
+        if (d > dist[u])
+            continue;
+        for (const Edge &e : graph.neighbors(u))
+        {
+            if (dist[e.destination] < 0 || d + e.weight < dist[e.destination])
+            {
+                dist[e.destination] = d + e.weight;
+                queue.push({dist[e.destination], e.destination});
+            }
+        }
+    }
+    double total = 0;
+    for (double d : dist)
+        total += max(d, 0.0);
+    return total;
+}
+
+// Traversal, shortest-path and greedy colouring time on CSR and LIST before and after reorder(), on the
+// shuffled grid or the preferential-attachment graph
+int benchReorder(int argc, char **argv)
+{
+    string kind = argc > 1 ? argv[1] : "grid";
+    ArcList edges;
+    int vertices = testGraphEdges(kind, edges);
+
+    const pair<RepresentationType, const char *> types[] = {{RepresentationType::CSR, "CSR"}, {RepresentationType::LIST, "LIST"}};
+    const pair<ReorderStrategy, const char *> orders[] = {
+        {ReorderStrategy::RCM, "RCM"}, {ReorderStrategy::BFS, "BFS"}, {ReorderStrategy::DEGREE, "DEGREE"}};
+    for (const auto &[type, typeName] : types)
+    {
+        if (argc > 2 && strcmp(argv[2], typeName) != 0)
+            continue;
+        for (int order = -1; order < 3; ++order)
+        {
+            Graph graph = buildGraph(false, true, type, vertices, edges);
+            double reorderTime = 0;
+            if (order >= 0)
+            {
+                auto start = chrono::steady_clock::now();
+                graph.reorder(orders[order].first);
+                reorderTime = millisecondsSince(start);
+            }
+            // Labels move with their vertices, so every order starts from the same vertex
+            int source = graph.getVertexIndex("0");
+
+            // Best of three
+            double bfs = 1e18, dijkstra = 1e18, coloring = 1e18, distances = 0;
+            unsigned long checksum = 0;
+            int colors = 0;
+            for (int run = 0; run < 3; ++run)
+            {
+                auto start = chrono::steady_clock::now();
+                checksum += breadthFirst(graph);
+                bfs = min(bfs, millisecondsSince(start));
+                start = chrono::steady_clock::now();
+                distances = shortestDistances(graph, source);
+                dijkstra = min(dijkstra, millisecondsSince(start));
+                start = chrono::steady_clock::now();
+                colors = greedy(graph).first;
+                coloring = min(coloring, millisecondsSince(start));
+            }
+            printf("%-6s %-4s %-6s reorder %7.1f ms | bfs %7.1f ms | dijkstra %7.1f ms | greedy %7.1f ms | distances %.0f colors %d\n",
+                   kind.c_str(), typeName, order < 0 ? "file" : orders[order].second, reorderTime, bfs, dijkstra, coloring,
+                   distances, colors);
+        }
+    }
+    return 0;
+}
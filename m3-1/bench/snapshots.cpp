@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "bench.hpp"
+#include "basic_graph.hpp"
+#include "graph_snapshots.hpp"
+
+// Whether a pinned version is whole: version k of the writer below has base + k vertices and arcs, the
+// newest vertex labelled with its index, and degrees, in-degrees and a BasicGraph view that all agree
+static bool consistent(const Graph &graph, int baseVertices, size_t baseArcs)
+{
+    int n = graph.getVertexCount();
+    size_t arcs = 0, inArcs = 0;
+    for (int u = 0; u < n; ++u)
+    {
+        arcs += graph.getDegree(u);
+        inArcs += graph.getInDegree(u);
+    }
+    size_t viewed = visitGraph(graph, [](const auto &view)
+                               {
+        size_t count = 0;
+        for (int u = 0; u < view.getVertexCount(); ++u)
+            view.forEachNeighbor(u, [&](int, weight_t) { ++count; });
+        return count; });
+    return n >= baseVertices && arcs == baseArcs + (n - baseVertices) && inArcs == arcs && viewed == arcs &&
+           graph.getVertexIndex(to_string(n - 1)) == n - 1;
+}
+
+// Stress check of GraphSnapshots' lock-free pin, publish and reclaim: reader threads pin and check
+// versions while the writer publishes new ones, each adding a vertex and an arc into it. Exits with 1
+// if a reader sees a torn or freed version, or replaced versions outlive their pins.
+int benchSnapshots(int argc, char **argv)
+{
+    const int vertices = 2000, readers = 6, versions = 300;
+    const pair<RepresentationType, const char *> types[] = {
+        {RepresentationType::LIST, "LIST"}, {RepresentationType::HYBRID, "HYBRID"}, {RepresentationType::CSR, "CSR"}};
+
+    for (const auto &[type, typeName] : types)
+    {
+        if (argc > 1 && strcmp(argv[1], typeName) != 0)
+            continue;
+        mt19937 rng(19);
+        ArcList edges;
+        for (int i = 0; i < 4 * vertices; ++i)
+            edges.emplace_back(rng() % vertices, rng() % vertices, 1);
+        const size_t baseArcs = edges.size();
+        GraphSnapshots snapshots(buildGraph(true, true, type, vertices, edges), readers + 2);
+
+        atomic<bool> done{false};
+        atomic<long> reads{0}, torn{0};
+        vector<thread> pool;
+        for (int r = 0; r < readers; ++r)
+        {
+            pool.emplace_back([&]
+                              {
+                while (!done)
+                {
+                    GraphSnapshots::Pin pin = snapshots.pin();
+                    if (!consistent(*pin, vertices, baseArcs))
+                        ++torn;
+                    ++reads;
+                } });
+        }
+
+        for (int k = 1; k <= versions; ++k)
+        {
+            int added = vertices + k - 1;
+            edges.emplace_back(rng() % (added + 1), added, 1);
+            // CSR is frozen, so its next version is rebuilt; the others edit a draft
+            if (type == RepresentationType::CSR)
+                snapshots.publish(buildGraph(true, true, type, added + 1, edges));
+            else
+            {
+                Graph draft = snapshots.draft();
+                draft.addVertex(to_string(added));
+                draft.addEdge(get<0>(edges.back()), added, 1);
+                draft.finalize();
+                snapshots.publish(move(draft));
+            }
+        }
+        done = true;
+        for (thread &reader : pool)
+            reader.join();
+
+        // With every pin released, the next publish must free all replaced versions
+        snapshots.publish(snapshots.draft());
+        bool ok = torn == 0 && snapshots.retiredCount() == 0 && consistent(snapshots.latest(), vertices, baseArcs);
+        printf("%-6s %d versions, %ld pinned reads by %d threads, %ld inconsistent, %zu retired left | %s\n", typeName,
+               versions, reads.load(), readers, torn.load(), snapshots.retiredCount(), ok ? "ok" : "FAILED");
+        if (!ok)
+            return 1;
+    }
+    return 0;
+}
@@ -10,10 +10,10 @@
 using namespace std;
 
 // Prim's algorithm
-pair<int, vector<tuple<int, int, int>>> prim_mst(Graph &graph);
+pair<weight_t, vector<tuple<weight_t, int, int>>> prim_mst(Graph &graph);
 
 // Kruskal's algorithm
-pair<int, vector<tuple<int, int, int>>> kruskal_mst(Graph &graph);
+pair<weight_t, vector<tuple<weight_t, int, int>>> kruskal_mst(Graph &graph);
 
 // Disjoint Set Union for Kruskal
 struct DSU
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "graph.hpp"
+
+using namespace std;
+
+// Per-edge weight access. The unweighted specialisation is empty, so BasicGraph inherits it
+// (empty base) and an unweighted instantiation carries no weight pointer at all.
+template <bool Weighted>
+struct WeightColumn
+{
+    const weight_t *values = nullptr;
+    weight_t weightAt(size_t pos) const { return values[pos]; }
+};
+
+template <>
+struct WeightColumn<false>
+{
+    weight_t weightAt(size_t) const { return 1; }
+};
+
+// Read-only view of a Graph whose weighting and representation are template parameters, so
+// traversal code compiles to a single branch-free loop per instantiation. Directedness is not a
+// parameter: the stored arcs already encode it, and no traversal needs to tell the cases apart.
+// It points into the Graph's storage and is only valid while the graph is not modified.
+// forEachNeighbor(v, visit) calls visit(destination, weight) for every out-edge of v.
+template <bool Weighted, RepresentationType Repr>
+class BasicGraph;
+
+template <bool Weighted>
+class BasicGraph<Weighted, RepresentationType::MATRIX> : private WeightColumn<Weighted>
+{
+public:
+    explicit BasicGraph(const Graph &graph)
+        : cells(graph.matrix.data()), stride(graph.matrixStride), vertexCount(graph.getVertexCount()) {}
+
+    int getVertexCount() const { return vertexCount; }
+
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        const weight_t *row = cells + (size_t)vertex * stride;
+        for (int u = 0; u < vertexCount; ++u)
+            if (row[u] != 0)
+                visit(u, Weighted ? row[u] : weight_t(1));
+    }
+
+private:
+    const weight_t *cells;
+    int stride;
+    int vertexCount;
+};
+
+template <bool Weighted>
+class BasicGraph<Weighted, RepresentationType::LIST> : private WeightColumn<Weighted>
+{
+public:
+    explicit BasicGraph(const Graph &graph)
+        : rows(&graph.adjacencyList), dead(graph.removedCount ? graph.removed.data() : nullptr),
+          vertexCount(graph.getVertexCount()) {}
+
+    int getVertexCount() const { return vertexCount; }
+
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        for (const Edge &e : (*rows)[vertex].edges)
+            if (!dead || !dead[e.destination])
+                visit(e.destination, Weighted ? e.weight : weight_t(1));
+    }
+
+private:
+    const AdjacencyLists *rows;
+    const char *dead;
+    int vertexCount;
+};
+
+template <bool Weighted>
+class BasicGraph<Weighted, RepresentationType::CSR> : private WeightColumn<Weighted>
+{
+public:
+    // An unfinalized CSR graph has no rows yet and is seen as edgeless
+    explicit BasicGraph(const Graph &graph)
+        : offsets(graph.frozen ? graph.csrOffsets.data() : nullptr), targets(graph.csrTargets.data()),
+          dead(graph.removedCount ? graph.removed.data() : nullptr), vertexCount(graph.getVertexCount())
+    {
+        if constexpr (Weighted)
+            this->values = graph.csrWeights.data();
+    }
+
+    int getVertexCount() const { return vertexCount; }
+
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        if (!offsets || (dead && dead[vertex]))
+            return;
+        for (int pos = offsets[vertex]; pos < offsets[vertex + 1]; ++pos)
+            if (!dead || !dead[targets[pos]])
+                visit(targets[pos], this->weightAt(pos));
+    }
+
+private:
+    const int *offsets;
+    const vertex_t *targets;
+    const char *dead;
+    int vertexCount;
+};
+
+template <bool Weighted>
+class BasicGraph<Weighted, RepresentationType::HYBRID> : private WeightColumn<Weighted>
+{
+public:
+    explicit BasicGraph(const Graph &graph)
+        : offsets(graph.csrOffsets.data()), targets(graph.csrTargets.data()), slots(graph.deltas.empty() ? nullptr : graph.deltaSlot.data()), rows(graph.deltas.data()),
+          dead(graph.removedCount ? graph.removed.data() : nullptr), vertexCount(graph.getVertexCount())
+    {
+        if constexpr (Weighted)
+            this->values = graph.csrWeights.data();
+    }
+
+    int getVertexCount() const { return vertexCount; }
+
+    // Rows without pending edits take the CSR loop (slots is null when no row has any)
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        if (dead && dead[vertex])
+            return;
+        if (slots && slots[vertex] != -1)
+        {
+            forEachEditedNeighbor(vertex, visit);
+            return;
+        }
+        for (int pos = offsets[vertex]; pos < offsets[vertex + 1]; ++pos)
+            if (!dead || !dead[targets[pos]])
+                visit(targets[pos], this->weightAt(pos));
+    }
+
+private:
+    // Not inlined: with it inlined, the plain loop in forEachNeighbor ran ~20% behind CSR's
+    template <typename F>
+    __attribute__((noinline)) void forEachEditedNeighbor(int vertex, F &visit) const
+    {
+        const Graph::DeltaRow &row = rows[slots[vertex]];
+        const vertex_t *erased = row.erased.data();
+        const vertex_t *erasedEnd = erased + row.erased.size();
+        for (int pos = offsets[vertex]; pos < offsets[vertex + 1]; ++pos)
+        {
+            while (erased != erasedEnd && *erased < targets[pos])
+                ++erased;
+            if ((erased == erasedEnd || *erased != targets[pos]) && (!dead || !dead[targets[pos]]))
+                visit(targets[pos], this->weightAt(pos));
+        }
+        for (const Edge &e : row.added)
+            if (!dead || !dead[e.destination])
+                visit(e.destination, Weighted ? e.weight : weight_t(1));
+    }
+
+    const int *offsets;
+    const vertex_t *targets;
+    const int *slots;
+    const Graph::DeltaRow *rows;
+    const char *dead;
+    int vertexCount;
+};
+
+template <bool Weighted>
+class BasicGraph<Weighted, RepresentationType::COMPRESSED>
+{
+public:
+    // Like CSR, an unfinalized graph is seen as edgeless
+    explicit BasicGraph(const Graph &graph)
+        : bytes(graph.packedBytes.data()), offsets(graph.frozen ? graph.packedOffsets.data() : nullptr),
+          dead(graph.removedCount ? graph.removed.data() : nullptr), vertexCount(graph.getVertexCount()) {}
+
+    int getVertexCount() const { return vertexCount; }
+
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        if (!offsets || (dead && dead[vertex]))
+            return;
+        const uint8_t *end;
+        const uint8_t *cursor = Graph::packedRow(bytes, offsets, vertex, end);
+        if (cursor == end)
+            return;
+        int64_t destination = vertex + unzigzag(readVarint(cursor));
+        while (true)
+        {
+            weight_t weight = 1;
+            if constexpr (Weighted)
+            {
+                memcpy(&weight, cursor, sizeof(weight_t));
+                cursor += sizeof(weight_t);
+            }
+            if (!dead || !dead[destination])
+                visit((vertex_t)destination, weight);
+            if (cursor == end)
+                break;
+            destination += readVarint(cursor);
+        }
+    }
+
+private:
+    const uint8_t *bytes;
+    const uint64_t *offsets;
+    const char *dead;
+    int vertexCount;
+};
+
+template <>
+class BasicGraph<false, RepresentationType::BITMATRIX>
+{
+public:
+    explicit BasicGraph(const Graph &graph)
+        : words(graph.bitMatrix.data()), rowWords(graph.bitWords), vertexCount(graph.getVertexCount()) {}
+
+    int getVertexCount() const { return vertexCount; }
+
+    template <typename F>
+    void forEachNeighbor(int vertex, F &&visit) const
+    {
+        const uint64_t *row = words + (size_t)vertex * rowWords;
+        for (int w = 0; w < rowWords; ++w)
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1)
+                visit(w * 64 + __builtin_ctzll(bits), weight_t(1));
+    }
+
+private:
+    const uint64_t *words;
+    int rowWords;
+    int vertexCount;
+};
+
+template <bool Weighted, typename F>
+auto visitRepresentation(const Graph &graph, F &&f)
+{
+    switch (graph.getRepresentation())
+    {
+    case RepresentationType::MATRIX:
+        return f(BasicGraph<Weighted, RepresentationType::MATRIX>(graph));
+    case RepresentationType::LIST:
+        return f(BasicGraph<Weighted, RepresentationType::LIST>(graph));
+    case RepresentationType::CSR:
+        return f(BasicGraph<Weighted, RepresentationType::CSR>(graph));
+    case RepresentationType::COMPRESSED:
+        return f(BasicGraph<Weighted, RepresentationType::COMPRESSED>(graph));
+    case RepresentationType::HYBRID:
+        return f(BasicGraph<Weighted, RepresentationType::HYBRID>(graph));
+    default:
+        return f(BasicGraph<false, RepresentationType::BITMATRIX>(graph));
+    }
+}
+
+// Calls f with the BasicGraph instantiation matching the graph's runtime configuration.
+// f is usually a generic lambda, so its body is compiled once per instantiation.
+template <typename F>
+auto visitGraph(const Graph &graph, F &&f)
+{
+    return graph.isWeighted() ? visitRepresentation<true>(graph, f) : visitRepresentation<false>(graph, f);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include "graph.hpp"
+
+using namespace std;
+
+// Gives every arc of a graph an edge id and keeps per-edge properties in columns indexed by it (one
+// vector per property), so an algorithm reads and writes only the columns it needs and never the graph.
+// Ids follow the graph's arc order: sources ascending, each source's arcs in neighbors() order, which
+// for a CSR graph makes an arc's id its CSR position. An undirected edge is two arcs, each with its own
+// id. The table is a snapshot: its ids and columns stay valid whatever is done to the graph afterwards.
+class EdgeTable
+{
+public:
+    // Starts as each arc's weight (1 for unweighted graphs)
+    vector<weight_t> capacity;
+
+    explicit EdgeTable(const Graph &graph);
+
+    int getVertexCount() const { return offsets.size() - 1; }
+    int getEdgeCount() const { return targets.size(); }
+    // Ids of the arcs leaving `vertex` are firstEdge(vertex) .. firstEdge(vertex + 1) - 1
+    int firstEdge(int vertex) const { return offsets[vertex]; }
+    int source(int id) const { return sources[id]; }
+    int target(int id) const { return targets[id]; }
+    // Ids of the arcs entering `vertex`, in ascending order
+    const int *inEdgesBegin(int vertex) const { return inIds.data() + inOffsets[vertex]; }
+    const int *inEdgesEnd(int vertex) const { return inIds.data() + inOffsets[vertex + 1]; }
+    // Id of the first arc source -> destination, or -1 if there is none
+    int findEdge(int source, int destination) const;
+
+    // A new property column with one `value` per edge, e.g. flows, costs or user tags
+    template <typename T>
+    vector<T> newColumn(T value = T()) const { return vector<T>(targets.size(), value); }
+
+private:
+    vector<int> offsets;
+    vector<vertex_t> targets;
+    vector<vertex_t> sources;
+    vector<int> inOffsets;
+    vector<int> inIds;
+};
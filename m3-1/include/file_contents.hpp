@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+// A whole file in memory: mapped read-only when the OS allows it (regular, non-empty files), read into a
+// heap buffer otherwise. Either way begin() is suitably aligned for any scalar type, except in a buffered
+// file shorter than 16 bytes.
+class FileContents
+{
+public:
+    explicit FileContents(const string &filename);
+    ~FileContents();
+    FileContents(const FileContents &) = delete;
+    FileContents &operator=(const FileContents &) = delete;
+
+    bool isOpen() const { return opened; }
+    const char *begin() const { return mapped ? mapped : buffer.data(); }
+    const char *end() const { return begin() + size; }
+    // Hints that the file will be read once, front to back, so the kernel can read ahead aggressively
+    void adviseSequential() const;
+
+private:
+    const char *mapped = nullptr;
+    string buffer;
+    size_t size = 0;
+    bool opened = false;
+};
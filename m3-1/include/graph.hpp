@@ -4,51 +4,668 @@
 #include <unordered_map>
 #include <list>
 #include <tuple>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <deque>
+#include <string_view>
+#include <cstring>
+#include <atomic>
+#include <functional>
 
 using namespace std;
 
+// Stored vertex id and edge weight types, fixed at configure time (GRAPH_VERTEX_TYPE and GRAPH_WEIGHT_TYPE
+// in CMakeLists.txt). Every edge endpoint kept in storage is a vertex_t; method arguments and per-vertex
+// algorithm arrays stay int. Weights, capacities, flows and MST totals are all weight_t.
+#ifndef GRAPH_VERTEX_TYPE
+#define GRAPH_VERTEX_TYPE int32_t
+#endif
+#ifndef GRAPH_WEIGHT_TYPE
+#define GRAPH_WEIGHT_TYPE float
+#endif
+using vertex_t = GRAPH_VERTEX_TYPE;
+using weight_t = GRAPH_WEIGHT_TYPE;
+
 enum class RepresentationType
 {
     MATRIX,
-    LIST
+    LIST,
+    CSR,
+    // One bit per cell; stores no weights, so graphs using it are always unweighted
+    BITMATRIX,
+    // Read-only like CSR, with each sorted row delta-encoded in variable-length bytes (see Graph)
+    COMPRESSED,
+    // CSR base plus per-vertex edit buffers, so edges can be added and removed; merge() folds the edits
+    // into a new base
+    HYBRID,
+    // Load-time choice from the vertex and edge counts (see Graph::chooseRepresentation); a Graph
+    // constructed with AUTO has nothing to go on and uses LIST
+    AUTO
+};
+
+// Vertex orders for Graph::reorder: Reverse Cuthill-McKee (bandwidth reduction), degree descending,
+// and breadth- or depth-first discovery order
+enum class ReorderStrategy
+{
+    RCM,
+    DEGREE,
+    BFS,
+    DFS
+};
+
+// Settings for Graph::buildFromEdges
+struct CsrBuildOptions
+{
+    // 0 picks one thread per hardware thread, fewer for small inputs
+    int threads = 0;
+    bool dropSelfLoops = false;
+    // Of several arcs with the same source and destination, only the first in input order is kept
+    bool dropDuplicates = false;
+};
+
+// Receives one batch of {source, destination, weight} edges (see Graph::buildFromStream)
+using EdgeSink = function<void(const vector<tuple<vertex_t, vertex_t, weight_t>> &)>;
+
+// Approximate heap bytes held by a graph. Weights are the bytes that only exist to store edge weights
+// (matrix cells and CSR weights of weighted graphs, the weight field of list nodes); structure is the rest
+// of the adjacency storage. Rows and labels shared with copies are counted in full by each copy.
+struct MemoryFootprint
+{
+    size_t structure = 0;
+    size_t labels = 0;
+    size_t weights = 0;
+
+    size_t total() const { return structure + labels + weights; }
 };
 
 struct Edge
 {
-    int destination;
-    float weight;
+    vertex_t destination;
+    weight_t weight;
+};
+
+// COMPRESSED rows are LEB128 varints: 7 bits per byte, the high bit set on every byte but the last
+inline uint64_t readVarint(const uint8_t *&cursor)
+{
+    if (*cursor < 0x80)
+        return *cursor++;
+    uint64_t value = *cursor & 0x7f;
+    for (int shift = 7; *cursor++ & 0x80; shift += 7)
+        value |= (uint64_t)(*cursor & 0x7f) << shift;
+    return value;
+}
+
+// Signed gaps are zigzag-encoded so small negative values stay short: 0, -1, 1, -2 ... -> 0, 1, 2, 3 ...
+inline int64_t unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// LIST rows draw their nodes from the graph's arena (see AdjacencyLists)
+using EdgeList = pmr::list<Edge>;
+
+// Walks the out-edges of one vertex in place, yielding {destination, weight} without allocating
+class NeighborIterator
+{
+public:
+    Edge operator*() const
+    {
+        if (kind == RepresentationType::MATRIX)
+            return {(vertex_t)index, row[index]};
+        if (kind == RepresentationType::LIST)
+            return *node;
+        if (kind == RepresentationType::BITMATRIX)
+            return {(vertex_t)(index * 64 + __builtin_ctzll(bits)), 1};
+        if (kind == RepresentationType::COMPRESSED)
+            return decoded;
+        if (kind == RepresentationType::HYBRID && target == targetEnd)
+            return *extra;
+        return {*target, weight ? *weight : 1};
+    }
+
+    NeighborIterator &operator++()
+    {
+        step();
+        skipRemoved();
+        return *this;
+    }
+
+    bool operator!=(const NeighborIterator &other) const
+    {
+        if (kind == RepresentationType::MATRIX)
+            return index != other.index;
+        if (kind == RepresentationType::LIST)
+            return node != other.node;
+        if (kind == RepresentationType::BITMATRIX)
+            return index != other.index || bits != other.bits;
+        if (kind == RepresentationType::COMPRESSED)
+            return packed != other.packed;
+        if (kind == RepresentationType::HYBRID)
+            return target != other.target || extra != other.extra;
+        return target != other.target;
+    }
+
+private:
+    friend class Graph;
+
+    RepresentationType kind;
+    // MATRIX: position in the row, which only stops on non-zero cells.
+    // BITMATRIX reuses index/end as the current word and the word count.
+    const weight_t *row = nullptr;
+    int index = 0;
+    int end = 0;
+    // BITMATRIX: remaining set bits of words[index]
+    const uint64_t *words = nullptr;
+    uint64_t bits = 0;
+    // LIST
+    EdgeList::const_iterator node;
+    EdgeList::const_iterator nodeEnd;
+    // CSR: weight is null for unweighted graphs
+    const vertex_t *target = nullptr;
+    const vertex_t *targetEnd = nullptr;
+    const weight_t *weight = nullptr;
+    // COMPRESSED: packed is the encoding of the decoded arc and packedNext the one after it
+    const uint8_t *packed = nullptr;
+    const uint8_t *packedNext = nullptr;
+    const uint8_t *packedEnd = nullptr;
+    Edge decoded = {0, 1};
+    bool packedWeights = false;
+    // HYBRID rows with pending edits: the base arcs (in target/weight) minus the sorted `erased`
+    // destinations, then the `extra` arcs added since. Rows without edits are iterated as CSR.
+    const vertex_t *erased = nullptr;
+    const vertex_t *erasedEnd = nullptr;
+    const Edge *extra = nullptr;
+    const Edge *extraEnd = nullptr;
+    // LIST, CSR and COMPRESSED leave edges into removed vertices in place; this flags them (null when there are none)
+    const char *dead = nullptr;
+
+    void step()
+    {
+        if (kind == RepresentationType::MATRIX)
+        {
+            ++index;
+            skipEmptyCells();
+        }
+        else if (kind == RepresentationType::LIST)
+            ++node;
+        else if (kind == RepresentationType::BITMATRIX)
+        {
+            bits &= bits - 1;
+            skipEmptyWords();
+        }
+        else if (kind == RepresentationType::COMPRESSED)
+        {
+            packed = packedNext;
+            if (packed != packedEnd)
+                decode(false);
+        }
+        else if (kind == RepresentationType::HYBRID && target == targetEnd)
+            ++extra;
+        else if (kind == RepresentationType::HYBRID)
+        {
+            ++target;
+            if (weight)
+                ++weight;
+            skipErased();
+        }
+        else
+        {
+            ++target;
+            if (weight)
+                ++weight;
+        }
+    }
+
+    bool atEnd() const
+    {
+        if (kind == RepresentationType::LIST)
+            return node == nodeEnd;
+        if (kind == RepresentationType::COMPRESSED)
+            return packed == packedEnd;
+        if (kind == RepresentationType::HYBRID)
+            return target == targetEnd && extra == extraEnd;
+        return target == targetEnd;
+    }
+
+    // Base rows and `erased` are both sorted, so `erased` only moves forward
+    void skipErased()
+    {
+        while (target != targetEnd)
+        {
+            while (erased != erasedEnd && *erased < *target)
+                ++erased;
+            if (erased == erasedEnd || *erased != *target)
+                return;
+            ++target;
+            if (weight)
+                ++weight;
+        }
+    }
+
+    // The first destination of a row is stored relative to its source (in decoded.destination),
+    // every later one as the gap to the previous destination
+    void decode(bool first)
+    {
+        packedNext = packed;
+        uint64_t gap = readVarint(packedNext);
+        decoded.destination = first ? (vertex_t)(decoded.destination + unzigzag(gap)) : (vertex_t)(decoded.destination + gap);
+        if (packedWeights)
+        {
+            memcpy(&decoded.weight, packedNext, sizeof(weight_t));
+            packedNext += sizeof(weight_t);
+        }
+    }
+
+    void skipRemoved()
+    {
+        while (dead && !atEnd() && dead[(**this).destination])
+            step();
+    }
+
+    void skipEmptyCells()
+    {
+        while (index < end && row[index] == 0)
+            ++index;
+    }
+
+    void skipEmptyWords()
+    {
+        while (bits == 0 && ++index < end)
+            bits = words[index];
+    }
+};
+
+struct NeighborRange
+{
+    NeighborIterator first;
+    NeighborIterator last;
+
+    NeighborIterator begin() const { return first; }
+    NeighborIterator end() const { return last; }
+};
+
+// Out-edges of one vertex in LIST mode. When the graph indexes its edges, `index` maps each
+// destination to its first edge in `edges`; copies rebuild it so it never points into another row.
+struct AdjacencyRow
+{
+    EdgeList edges;
+    unordered_map<int, EdgeList::iterator> index;
+
+    explicit AdjacencyRow(pmr::memory_resource *resource);
+    AdjacencyRow(const AdjacencyRow &other, pmr::memory_resource *resource);
+    AdjacencyRow(AdjacencyRow &&) = default;
+    AdjacencyRow &operator=(AdjacencyRow &&) = default;
+
+    void rebuildIndex();
+    EdgeList::iterator find(int destination, bool indexed);
+    EdgeList::const_iterator find(int destination, bool indexed) const;
+};
+
+// LIST storage, shared copy-on-write between copies of a graph. A copy takes a reference to every
+// row (V pointer copies, no edge is touched); edit(v) clones v's row if it is still shared, which
+// costs O(degree), and leaves every other row shared.
+// Edge nodes are bump-allocated from monotonic arenas. Each row keeps the arena holding its nodes
+// alive, and rows cloned or added by this storage draw from its own arena, created on first use.
+// Sharing is not synchronised: copies must not be modified concurrently from different threads.
+class AdjacencyLists
+{
+public:
+    AdjacencyLists() = default;
+    AdjacencyLists(const AdjacencyLists &other);
+    AdjacencyLists &operator=(const AdjacencyLists &other);
+    AdjacencyLists(AdjacencyLists &&) = default;
+    AdjacencyLists &operator=(AdjacencyLists &&) = default;
+
+    const AdjacencyRow &operator[](size_t vertex) const { return rows[vertex]->row; }
+    // Row of `vertex` for modification, cloned first if another graph still shares it
+    AdjacencyRow &edit(size_t vertex);
+    size_t size() const { return rows.size(); }
+    // Bytes of the row table and row objects of `rows` rows, excluding the edge nodes
+    static size_t rowBytes(size_t rows);
+    // Sizes the arena for `arcs` edge nodes; only takes effect before the first row is added
+    void reserve(size_t vertices, size_t arcs);
+    void addRow();
+
+private:
+    struct SharedRow
+    {
+        // Declared first so it is destroyed after the row that allocates from it
+        shared_ptr<pmr::monotonic_buffer_resource> arena;
+        AdjacencyRow row;
+
+        explicit SharedRow(shared_ptr<pmr::monotonic_buffer_resource> resource);
+        SharedRow(shared_ptr<pmr::monotonic_buffer_resource> resource, const AdjacencyRow &other);
+    };
+
+    shared_ptr<pmr::monotonic_buffer_resource> arena;
+    vector<shared_ptr<SharedRow>> rows;
+
+    const shared_ptr<pmr::monotonic_buffer_resource> &currentArena();
+};
+
+// Vertex labels, shared copy-on-write between copies of a graph like its LIST rows. While every
+// label is a plain number, as the file loader creates them, no string is stored: `identity` is set
+// and lookups parse the label instead. Vertex v is labelled to_string(v), or to_string(numbering[v])
+// once compact() or reorder() has moved vertices; position[] inverts numbering (-1 for dropped ones).
+// The first label that does not fit materialises the string table.
+struct VertexLabels
+{
+    bool identity = true;
+    vector<int> numbering;
+    vector<int> position;
+    // A deque keeps each label at a fixed address, so labelToIndex can key on views of them
+    deque<string> indexToLabel;
+    unordered_map<string_view, vertex_t> labelToIndex;
+
+    VertexLabels() = default;
+    VertexLabels(const VertexLabels &other);
+    VertexLabels &operator=(const VertexLabels &) = delete;
+};
+
+// One CSR array: owns its elements like a vector, or views elements owned by something else (the mapping
+// of a binary graph file, see Graph::openBinary) and keeps that owner alive. Copies of a view share the
+// elements; edit() copies them into owned storage first, as does any call that grows or refills the array.
+template <typename T>
+class CsrArray
+{
+public:
+    const T &operator[](size_t i) const { return data()[i]; }
+    const T *data() const { return owner ? viewed : owned.data(); }
+    const T *begin() const { return data(); }
+    const T &back() const { return data()[size() - 1]; }
+    size_t size() const { return owner ? viewedSize : owned.size(); }
+    bool empty() const { return size() == 0; }
+    // Allocated elements, or the viewed ones
+    size_t capacity() const { return owner ? viewedSize : owned.capacity(); }
+
+    T &edit(size_t i)
+    {
+        detach();
+        return owned[i];
+    }
+    void assign(size_t count, const T &value)
+    {
+        drop();
+        owned.assign(count, value);
+    }
+    void reserve(size_t count)
+    {
+        detach();
+        owned.reserve(count);
+    }
+    void push_back(const T &value)
+    {
+        detach();
+        owned.push_back(value);
+    }
+    // Takes other's elements; other gets the owned ones back (none when this was a view)
+    void swap(vector<T> &other)
+    {
+        drop();
+        owned.swap(other);
+    }
+    // Frees the elements
+    void clear()
+    {
+        drop();
+        vector<T>().swap(owned);
+    }
+    void view(shared_ptr<const void> elementsOwner, const T *elements, size_t count)
+    {
+        vector<T>().swap(owned);
+        owner = move(elementsOwner);
+        viewed = elements;
+        viewedSize = count;
+    }
+
+private:
+    vector<T> owned;
+    shared_ptr<const void> owner;
+    const T *viewed = nullptr;
+    size_t viewedSize = 0;
+
+    void detach()
+    {
+        if (owner)
+            owned.assign(viewed, viewed + viewedSize);
+        drop();
+    }
+    void drop()
+    {
+        owner.reset();
+        viewed = nullptr;
+        viewedSize = 0;
+    }
 };
 
+class FileContents;
+
+// Const methods never modify shared state, so any number of threads may read a graph nobody is editing;
+// GraphSnapshots lets one writer keep editing alongside them
 class Graph
 {
 private:
+    // Compile-time specialised views read the storage directly (see basic_graph.hpp)
+    template <bool Weighted, RepresentationType Repr>
+    friend class BasicGraph;
+
     bool directed;
     bool weighted;
     RepresentationType representation;
+    // LIST only: keep a per-vertex hash index so edge lookups are O(1) instead of O(degree)
+    bool indexEdges;
+
+    shared_ptr<VertexLabels> labels = make_shared<VertexLabels>();
+    // Tombstones: removeVertex only flags the vertex (and clears what it can in O(degree));
+    // compact() renumbers the survivors once
+    vector<char> removed;
+    int removedCount = 0;
+
+    // MATRIX: row-major in one buffer, cell (u, v) at matrix[u * matrixStride + v]. The stride is the
+    // column capacity (a multiple of 8 cells); it doubles when full, so rows are re-laid out O(log V) times.
+    vector<weight_t> matrix;
+    int matrixStride = 0;
+    AdjacencyLists adjacencyList;
+
+    // CSR: neighbors of v are csrTargets[csrOffsets[v] .. csrOffsets[v + 1]), sorted by destination.
+    // csrWeights is left empty for unweighted graphs (every weight is 1). Graphs opened from a binary file
+    // view the file's arrays until something modifies them.
+    CsrArray<int> csrOffsets;
+    CsrArray<vertex_t> csrTargets;
+    CsrArray<weight_t> csrWeights;
+    // BITMATRIX: row v is bitMatrix[v * bitWords .. (v + 1) * bitWords), bit u set when v -> u exists.
+    // bitWords doubles when the vertices outgrow it, so rows are re-laid out only O(log V) times.
+    vector<uint64_t> bitMatrix;
+    int bitWords = 0;
+    // COMPRESSED: row v is a varint byte length followed by its arcs sorted by destination, each the varint
+    // gap to the previous destination (the first zigzag-encoded relative to v) and, when weighted, the raw
+    // weight. Rows are stored back to back and only every PACKED_STRIDE-th row start is recorded, so
+    // packedRow() hops over at most PACKED_STRIDE - 1 row lengths to find a row.
+    static constexpr int PACKED_STRIDE = 8;
+    vector<uint64_t> packedOffsets;
+    vector<uint8_t> packedBytes;
+
+    // HYBRID: the CSR arrays are the base as of the last merge(). Edits since are kept per vertex in
+    // deltas[deltaSlot[v]]; rows whose slot is -1 have none and are read as plain CSR.
+    struct DeltaRow
+    {
+        // Destinations whose base arcs removeEdge deleted, sorted
+        vector<vertex_t> erased;
+        // Arcs added since the base was built, in insertion order
+        vector<Edge> added;
+    };
+    vector<DeltaRow> deltas;
+    vector<int> deltaSlot;
+    size_t deltaEdits = 0;
+
+    // Directed graphs only: in-edges in CSR layout, sources of v at sources[offsets[v] .. offsets[v + 1]) in
+    // ascending order (weights empty when unweighted). Built by inNeighbors() on first use and dropped by
+    // every edit, so a graph pays for it only while it is queried between edits; copies share it.
+    struct InEdges
+    {
+        vector<int> offsets;
+        vector<vertex_t> sources;
+        vector<weight_t> weights;
+    };
+    // Readers may fill it from several threads at once: the owning pointer is only read, copied and filled
+    // through the atomic shared_ptr functions, and `ready` repeats it so lookups need a single atomic load
+    // (see reverseIndex). Edits, made by a single writer, reset it directly.
+    struct InEdgesCache
+    {
+        shared_ptr<const InEdges> index;
+        atomic<const InEdges *> ready{nullptr};
+
+        InEdgesCache() = default;
+        InEdgesCache(const InEdgesCache &other) : index(atomic_load(&other.index)), ready(index.get()) {}
+        InEdgesCache &operator=(const InEdgesCache &other)
+        {
+            index = atomic_load(&other.index);
+            ready = index.get();
+            return *this;
+        }
+        void reset()
+        {
+            index.reset();
+            ready = nullptr;
+        }
+    };
+    mutable InEdgesCache inEdges;
 
-    unordered_map<string, int> labelToIndex;
-    vector<string> indexToLabel;
+    // Edges staged by addEdge until finalize() builds the CSR or COMPRESSED arrays
+    vector<tuple<vertex_t, vertex_t, weight_t>> pendingEdges;
+    bool frozen = false;
 
-    vector<vector<float>> matrix;
-    vector<list<Edge>> adjacencyList;
+    int csrFind(int source, int destination) const;
+    // COMPRESSED: whether the arc exists, storing its weight in `weight` when it does
+    bool packedFind(int source, int destination, weight_t &weight) const;
+    const uint8_t *packedRow(int vertex, const uint8_t *&end) const
+    {
+        return packedRow(packedBytes.data(), packedOffsets.data(), vertex, end);
+    }
+    static const uint8_t *packedRow(const uint8_t *bytes, const uint64_t *offsets, int vertex, const uint8_t *&end)
+    {
+        const uint8_t *cursor = bytes + offsets[vertex / PACKED_STRIDE];
+        for (int skip = vertex % PACKED_STRIDE; skip > 0; --skip)
+            cursor += readVarint(cursor);
+        size_t length = readVarint(cursor);
+        end = cursor + length;
+        return cursor;
+    }
+    DeltaRow &editDelta(int vertex);
+    void addDeltaArc(int source, int destination, weight_t weight);
+    void eraseDeltaArc(int source, int destination);
+    // HYBRID: whether the arc exists, storing its weight in `weight` when it does
+    bool hybridFind(int source, int destination, weight_t &weight) const;
+    void mergeIfLarge();
+    shared_ptr<const InEdges> buildInEdges() const;
+    const InEdges &reverseIndex() const;
+    // Fills the CSR arrays from `edges` (plus their mirrors when `mirror` is set) with parallel counting,
+    // prefix sums and scatters. Fails without changes, when `validate` is set, if an endpoint is out of
+    // range or removed.
+    bool buildCsrArrays(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges, bool mirror, bool validate,
+                        const CsrBuildOptions &options);
+    // COMPRESSED: encodes the CSR arrays into packed rows and frees them
+    void packCsrArrays();
+    // HYBRID: new base from the current rows plus `extra` edges, with the edit buffers emptied
+    void rebuildBase(const vector<tuple<vertex_t, vertex_t, weight_t>> &extra);
+    weight_t &cell(int source, int destination) { return matrix[(size_t)source * matrixStride + destination]; }
+    weight_t cell(int source, int destination) const { return matrix[(size_t)source * matrixStride + destination]; }
+    void appendVertexStorage();
+    // Labels for modification, cloned first if another graph still shares them
+    VertexLabels &editLabels();
+    // Leaves identity mode by storing every vertex's label explicitly
+    void materializeLabels();
+    void renumber(const vector<int> &newIndex);
 
 public:
-    Graph(bool directed, bool weighted, RepresentationType representation);
+    Graph(bool directed, bool weighted, RepresentationType representation, bool indexEdges = false);
 
-    bool addVertex(string label);
-    bool removeVertex(string label);
-    bool addEdge(int source, int destination, float weight = 1.0);
+    // Pre-sizes storage for `vertices` vertices (and `edges` edges where the representation can use it)
+    // so loading them does not re-lay out the matrix rows or grow the staging buffers
+    void reserve(int vertices, int edges = 0);
+    bool addVertex(string_view label);
+    // Tombstones the vertex: it keeps its index but loses its label and edges until compact()
+    bool removeVertex(string_view label);
+    // Renumbers the live vertices densely, returning each old index's new index (-1 if removed)
+    vector<int> compact();
+    // Renumbers the vertices so neighbors get nearby indices, dropping removed vertices like compact().
+    // Returns each old index's new index (-1 if removed); labels move with their vertices.
+    vector<int> reorder(ReorderStrategy strategy);
+    MemoryFootprint memoryFootprint() const;
+    // Estimated footprint of a graph with `vertices` vertices and `arcs` stored arcs (undirected edges
+    // count twice) in the given representation, numerically labelled as the file loader creates them
+    static size_t estimateFootprint(RepresentationType type, int vertices, size_t arcs, bool weighted, bool indexEdges = false);
+    // Representation for AUTO: an unweighted graph gets a bit matrix, which answers edge queries in O(1),
+    // while it costs at most twice as much as CSR and fits `budget` bytes (0 = no limit). Weighted graphs
+    // never get a matrix, which would lose 0-weight and parallel arcs. Otherwise CSR, or COMPRESSED when
+    // only that fits the budget. INDEXED only applies to lists, so asking for it
+    // picks LIST.
+    static RepresentationType chooseRepresentation(int vertices, size_t arcs, bool weighted, size_t budget, bool indexEdges = false);
+    bool isRemoved(int vertex) const;
+    bool addEdge(int source, int destination, weight_t weight = 1);
+    // Adds {source, destination, weight} edges in one pass, grouped by source unless there are far fewer
+    // than vertices; each row gets its edges in input order either way. Either every edge is added or, if
+    // any endpoint is out of range or removed, none is.
+    bool addEdges(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges);
+    // CSR, COMPRESSED or HYBRID graphs without edges only: adds the edges (mirrored when undirected) and
+    // builds the final arrays in one pass on options.threads threads, so finalize() has nothing left to do.
+    // Rows are sorted by destination, keeping input order among equal ones, as finalize() sorts them.
+    // Fails without changes if an endpoint is out of range or removed.
+    bool buildFromEdges(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges, const CsrBuildOptions &options = {});
+    // Same, for edges too many to hold at once: readEdges(sink) is called twice and must pass the same
+    // edges in the same order, in batches of any size, to `sink` both times (degrees are counted on the
+    // first pass, arcs written in place on the second), returning false to give up. Needs no memory beyond
+    // the final arrays and O(V) counters. Fails without changes if readEdges does, an endpoint is out of
+    // range or removed, or the two passes differ.
+    bool buildFromStream(const function<bool(const EdgeSink &)> &readEdges);
     bool removeEdge(int source, int destination);
-    bool edgeExists(int source, int destination);
-    float edgeWeight(int source, int destination) const;
-    vector<int> getNeighbors(int vertex);
+    bool edgeExists(int source, int destination) const;
+    weight_t edgeWeight(int source, int destination) const;
+    NeighborRange neighbors(int vertex) const;
+    int getDegree(int vertex) const;
+    // Edges into a vertex, each Edge holding the source in `destination`; the same as neighbors() for
+    // undirected graphs. The first call after an edit builds the reverse index in O(V + E) (safe from
+    // concurrent readers), and any edit invalidates the ranges it returned.
+    NeighborRange inNeighbors(int vertex) const;
+    int getInDegree(int vertex) const;
     void printGraph();
-    int getVertexCount();
-    int getVertexIndex(string label);
-    string getVertexLabel(int index);
+    // Index bound for per-vertex arrays; includes removed vertices until compact()
+    int getVertexCount() const;
+    // Index of the live vertex with this label, or -1 if there is none
+    int getVertexIndex(string_view label) const;
+    string getVertexLabel(int index) const;
     bool isWeighted() const;
+    bool isDirected() const;
     Graph copy() const;
-    float getCapacity(int u, int v) const;
-    void addFlow(int u, int v, float delta);
-    vector<tuple<int, int, float>> getEdges() const;
+    // Residual capacity edits in place, for callers keeping their own residual graph; fordFulkerson
+    // leaves the graph alone and keeps flows in an EdgeTable column instead
+    weight_t getCapacity(int u, int v) const;
+    void addFlow(int u, int v, weight_t delta);
+    vector<tuple<vertex_t, vertex_t, weight_t>> getEdges() const;
+    RepresentationType getRepresentation() const;
+    // Builds the immutable CSR or COMPRESSED arrays from the staged edges, or merges a HYBRID graph's
+    // edits; no-op for the other representations
+    void finalize();
+    // HYBRID only: folds the pending edits into a new CSR base in O(V + E). It also runs on its own
+    // once the edits reach 1/32 of the base arcs, so edited rows stay a small share of any traversal.
+    void merge();
+    Graph convertTo(RepresentationType target) const;
+    // Writes the graph as a binary file that openBinary() can use in place: CSR arrays without tombstones
+    // plus the labels (other representations are converted on the way). False if the file cannot be written.
+    bool saveBinary(const string &filename) const;
+    // Whether the bytes start like a file written by saveBinary()
+    static bool isBinaryFile(const char *begin, const char *end);
+    // CSR graph over the arrays of a saveBinary() file, used where they lie in `file` without copying;
+    // the file stays open while the graph or any copy still views it. Costs O(V): the offsets and labels
+    // are checked, the targets are not read. verifyTargets also checks every target in one O(E) pass;
+    // without it, a file whose targets were corrupted after saving yields a graph that reads out of bounds.
+    // Null, with the reason in `error`, if the file is not a binary graph written with this build's byte
+    // order and vertex and weight types, or if a row, label (or checked target) is out of range.
+    static Graph *openBinary(shared_ptr<const FileContents> file, bool indexEdges, string &error, bool verifyTargets = false);
+    // MATRIX only: contiguous row of a vertex, getVertexCount() cells long
+    const weight_t *matrixRow(int vertex) const;
+    // BITMATRIX only: packed adjacency row of a vertex, bitRowWords() words long
+    const uint64_t *bitRow(int vertex) const;
+    int bitRowWords() const;
 };
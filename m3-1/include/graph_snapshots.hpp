@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "graph.hpp"
+
+using namespace std;
+
+// Publishes immutable versions of a graph to concurrent readers while a single writer prepares the next
+// one (read-copy-update). Readers pin the current version without locks: a pin parks the version's
+// address in a hazard slot of its own, and the writer only deletes a replaced version once no slot holds
+// it. A pinned version never changes, so any const Graph method (and the navigation algorithms) can run
+// on it from any number of threads.
+//
+// Writer side, from one thread at a time: take draft(), edit it, publish() it. A draft of a LIST graph
+// shares every row and the labels with the published version until the writer edits them; the other
+// representations copy their arrays.
+class GraphSnapshots
+{
+private:
+    // One per cache line, so readers pinning in parallel do not contend on each other's slots
+    struct alignas(64) Slot
+    {
+        atomic<bool> claimed{false};
+        atomic<const Graph *> hazard{nullptr};
+    };
+
+public:
+    // Keeps its version alive until it is destroyed. Move-only; a moved-from pin holds nothing.
+    class Pin
+    {
+    public:
+        Pin(Pin &&other) noexcept;
+        Pin &operator=(Pin &&) = delete;
+        ~Pin();
+
+        const Graph &operator*() const { return *graph; }
+        const Graph *operator->() const { return graph; }
+
+    private:
+        friend class GraphSnapshots;
+        Pin(Slot *slot, const Graph *graph) : slot(slot), graph(graph) {}
+
+        Slot *slot;
+        const Graph *graph;
+    };
+
+    // At most maxReaders pins can be held at once; pin() waits for a free slot beyond that
+    explicit GraphSnapshots(Graph initial, int maxReaders = 64);
+    // Every pin must have been released
+    ~GraphSnapshots();
+    GraphSnapshots(const GraphSnapshots &) = delete;
+    GraphSnapshots &operator=(const GraphSnapshots &) = delete;
+
+    Pin pin() const;
+
+    // Writer only: the latest published version, and a modifiable copy of it
+    const Graph &latest() const;
+    Graph draft() const;
+    // Writer only: makes `next` the version new pins see, then frees the replaced versions no pin holds
+    void publish(Graph next);
+    // Writer only: replaced versions still held by a pin
+    size_t retiredCount() const;
+
+private:
+    unique_ptr<Slot[]> slots;
+    int slotCount;
+    atomic<const Graph *> current;
+    vector<const Graph *> retired;
+
+    void reclaim();
+};
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include "graph.hpp"
+#include "edge_table.hpp"
 
-int fordFulkerson(Graph original, int source, int sink);
-int localSearch(Graph &graph, int source, int sink, int iterations);
\ No newline at end of file
+weight_t fordFulkerson(const Graph &original, int source, int sink);
+// Ford-Fulkerson on the table's capacity column, returning {max_flow, flow per edge id}
+pair<weight_t, vector<weight_t>> fordFulkersonFlows(const EdgeTable &network, int source, int sink);
+weight_t localSearch(Graph &graph, int source, int sink, int iterations);
\ No newline at end of file
@@ -3,6 +3,6 @@
 #include "graph.hpp"
 #include <string>
 
-void bfs(Graph &graph, const std::string &startLabel);
-void dfs(Graph &graph, const std::string &startLabel);
-void dijkstra(Graph &graph, const std::string &startLabel);
+void bfs(const Graph &graph, const std::string &startLabel);
+void dfs(const Graph &graph, const std::string &startLabel);
+void dijkstra(const Graph &graph, const std::string &startLabel);
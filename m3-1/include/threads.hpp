@@ -0,0 +1,18 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Runs work(t) for every t in [0, threads), each on its own thread (t = 0 on the caller's)
+template <typename F>
+void onThreads(int threads, F work)
+{
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(work, t);
+    work(0);
+    for (thread &worker : pool)
+        worker.join();
+}
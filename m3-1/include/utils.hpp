@@ -3,4 +3,11 @@
 
 using namespace std;
 
-Graph *loadGraphFromFile(const string &filename, RepresentationType reprType);
+// Reads the project's "V A D P" text files, DIMACS, METIS (.graph or .metis), Matrix Market coordinate
+// and SNAP edge lists, telling them apart by their first line, as well as saveBinary() files.
+// AUTO picks the representation from the header's counts. A non-zero memoryBudget (bytes) rejects files
+// whose estimated footprint in the chosen representation exceeds it, before anything is allocated.
+// verifyBinary checks every edge target of a binary file opened as CSR or AUTO, which otherwise opens in
+// O(V) without reading them (other representations read every arc while converting, so always check).
+Graph *loadGraphFromFile(const string &filename, RepresentationType reprType, bool indexEdges = false, size_t memoryBudget = 0,
+                         bool verifyBinary = false);
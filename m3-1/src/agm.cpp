@@ -5,24 +5,23 @@
 
 #include "agm.hpp"
 #include "graph.hpp"
+#include "basic_graph.hpp"
 
 using namespace std;
 
-// Prim's algorithm implementation
-pair<int, vector<tuple<int, int, int>>> prim_mst(Graph &graph)
+// Prim's algorithm on a compile-time specialised view (see basic_graph.hpp)
+template <typename G>
+static pair<weight_t, vector<tuple<weight_t, int, int>>> primImpl(const G &graph, int start)
 {
-    using Edge = tuple<int, int, int>; // weight, from, to
+    using Edge = tuple<weight_t, int, int>; // weight, from, to
     priority_queue<Edge, vector<Edge>, greater<>> pq;
     vector<bool> visited(graph.getVertexCount(), false);
     vector<Edge> mst;
-    int total_weight = 0;
+    weight_t total_weight = 0;
 
-    visited[0] = true; // start at node 0
-    for (int neighbor : graph.getNeighbors(0))
-    {
-        int weight = graph.edgeWeight(0, neighbor);
-        pq.emplace(weight, 0, neighbor);
-    }
+    visited[start] = true;
+    graph.forEachNeighbor(start, [&](int to, weight_t weight)
+                          { pq.emplace(weight, start, to); });
 
     while (!pq.empty())
     {
@@ -34,38 +33,50 @@ pair<int, vector<tuple<int, int, int>>> prim_mst(Graph &graph)
         mst.emplace_back(weight, from, to);
         total_weight += weight;
 
-        for (int next : graph.getNeighbors(to))
-        {
+        graph.forEachNeighbor(to, [&, to = to](int next, weight_t weight)
+                              {
             if (!visited[next])
-            {
-                int w = graph.edgeWeight(to, next);
-                pq.emplace(w, to, next);
-            }
-        }
+                pq.emplace(weight, to, next); });
     }
 
     return {total_weight, mst};
 }
 
+// Prim's algorithm implementation
+pair<weight_t, vector<tuple<weight_t, int, int>>> prim_mst(Graph &graph)
+{
+    // start at the first vertex that has not been removed (node 0 unless it was)
+    int start = 0;
+    while (start < graph.getVertexCount() && graph.isRemoved(start))
+        start++;
+    if (start == graph.getVertexCount())
+        return {0, {}};
+
+    return visitGraph(graph, [&](const auto &view)
+                      { return primImpl(view, start); });
+}
+
 // Kruskal's algorithm implementation
-pair<int, vector<tuple<int, int, int>>> kruskal_mst(Graph &graph)
+pair<weight_t, vector<tuple<weight_t, int, int>>> kruskal_mst(Graph &graph)
 {
-    using Edge = tuple<int, int, int>; // weight, u, v
+    using Edge = tuple<weight_t, int, int>; // weight, u, v
     vector<Edge> edges;
 
-    // Get all edges from the graph
-    auto graph_edges = graph.getEdges();
-    for (const auto &[u, v, w] : graph_edges)
-    {
-        if (u < v) // avoid duplicates for undirected graphs
-            edges.emplace_back(w, u, v);
-    }
+    // Collect every edge once; u < v avoids duplicates for undirected graphs. Only positive weights
+    // count as edges, as getEdges() reports them.
+    visitGraph(graph, [&](const auto &view)
+               {
+        for (int u = 0; u < view.getVertexCount(); ++u)
+            view.forEachNeighbor(u, [&](int v, weight_t w)
+                                 {
+                if (u < v && w > 0)
+                    edges.emplace_back(w, u, v); }); });
 
     sort(edges.begin(), edges.end());
     DSU dsu(graph.getVertexCount());
 
     vector<Edge> mst;
-    int total_weight = 0;
+    weight_t total_weight = 0;
 
     for (auto [w, u, v] : edges)
     {
@@ -1,20 +1,75 @@
 #include <vector>
 #include <algorithm>
 #include <unordered_set>
+#include <numeric>
 
 #include "graph.hpp"
 #include "coloring_algorithms.hpp"
 
 using namespace std;
 
+// Bit-matrix helper: a color class is a packed vertex set, so u conflicts with it when its
+// adjacency row and the class share a bit (u's own bit is ignored, like self-loops elsewhere).
+static bool conflictsWithClass(const uint64_t *row, const vector<uint64_t> &colorClass, int u)
+{
+    for (size_t w = 0; w < colorClass.size(); ++w)
+    {
+        uint64_t overlap = row[w] & colorClass[w];
+        if ((int)w == u / 64)
+            overlap &= ~(1ULL << (u % 64));
+        if (overlap)
+            return true;
+    }
+    return false;
+}
+
+// Bit-matrix helper: greedy coloring in the given order, testing each color with row ANDs.
+static pair<int, vector<int>> greedyBits(Graph &g, const vector<int> &order)
+{
+    vector<int> colors(g.getVertexCount(), -1);
+    vector<vector<uint64_t>> classes;
+
+    for (int u : order)
+    {
+        const uint64_t *row = g.bitRow(u);
+        int c = 0;
+        while (c < (int)classes.size() && conflictsWithClass(row, classes[c], u))
+            ++c;
+        if (c == (int)classes.size())
+            classes.emplace_back(g.bitRowWords(), 0);
+        classes[c][u / 64] |= 1ULL << (u % 64);
+        colors[u] = c + 1;
+    }
+    return {(int)classes.size(), colors};
+}
+
 // Helper: check if current partial coloring is valid (no neighbors vertices share the same color).
 bool isValidColoring(Graph &g, vector<int> &colors)
 {
     int n = g.getVertexCount();
+    if (g.getRepresentation() == RepresentationType::BITMATRIX)
+    {
+        // Group vertices into color classes, then AND each row with its own class
+        vector<vector<uint64_t>> classes;
+        for (int u = 0; u < n; ++u)
+        {
+            if (colors[u] == -1)
+                continue;
+            if (colors[u] >= (int)classes.size())
+                classes.resize(colors[u] + 1, vector<uint64_t>(g.bitRowWords(), 0));
+            classes[colors[u]][u / 64] |= 1ULL << (u % 64);
+        }
+        for (int u = 0; u < n; ++u)
+            if (colors[u] != -1 && conflictsWithClass(g.bitRow(u), classes[colors[u]], u))
+                return false;
+        return true;
+    }
+
     for (int u = 0; u < n; ++u)
     {
-        for (int v : g.getNeighbors(u))
+        for (const Edge &e : g.neighbors(u))
         {
+            int v = e.destination;
             if (u < v && colors[u] != -1 && colors[u] == colors[v])
                 return false;
         }
@@ -72,6 +127,13 @@ pair<int, vector<int>> bruteForce(Graph &g)
 pair<int, vector<int>> greedy(Graph &g)
 {
     int n = g.getVertexCount();
+    if (g.getRepresentation() == RepresentationType::BITMATRIX)
+    {
+        vector<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        return greedyBits(g, order);
+    }
+
     vector<int> colors(n, -1);
     int maxColor = 0;
 
@@ -79,10 +141,10 @@ pair<int, vector<int>> greedy(Graph &g)
     for (int u = 0; u < n; ++u)
     {
         unordered_set<int> forbidden;
-        for (int v : g.getNeighbors(u))
+        for (const Edge &e : g.neighbors(u))
         {
-            if (colors[v] != -1)
-                forbidden.insert(colors[v]);
+            if (colors[e.destination] != -1)
+                forbidden.insert(colors[e.destination]);
         }
         // Find smallest color not in forbidden
         int c = 0;
@@ -103,21 +165,27 @@ pair<int, vector<int>> welshPowell(Graph &g)
     int n = g.getVertexCount();
     vector<int> colors(n, -1);
     vector<int> order(n);
+    vector<int> degree(n);
     // Create list of vertices [0..n-1]
     for (int i = 0; i < n; ++i)
+    {
         order[i] = i;
+        degree[i] = g.getDegree(i);
+    }
     // Sort by descending degree
     sort(order.begin(), order.end(), [&](int a, int b)
-         { return g.getNeighbors(a).size() > g.getNeighbors(b).size(); });
+         { return degree[a] > degree[b]; });
+    if (g.getRepresentation() == RepresentationType::BITMATRIX)
+        return greedyBits(g, order);
     int maxColor = 0;
 
     for (int u : order)
     {
         unordered_set<int> forbidden;
-        for (int v : g.getNeighbors(u))
+        for (const Edge &e : g.neighbors(u))
         {
-            if (colors[v] != -1)
-                forbidden.insert(colors[v]);
+            if (colors[e.destination] != -1)
+                forbidden.insert(colors[e.destination]);
         }
         int c = 0;
         while (forbidden.count(c))
@@ -140,7 +208,7 @@ pair<int, vector<int>> dsatur(Graph &g)
 
     // Initialize degrees
     for (int u = 0; u < n; ++u)
-        degree[u] = g.getNeighbors(u).size();
+        degree[u] = g.getDegree(u);
 
     int coloredCount = 0;
     int maxColor = 0;
@@ -172,9 +240,9 @@ pair<int, vector<int>> dsatur(Graph &g)
         maxColor = max(maxColor, c);
         ++coloredCount;
         // Update neighborColors for neighbors
-        for (int v : g.getNeighbors(best))
+        for (const Edge &e : g.neighbors(best))
         {
-            neighborColors[v].insert(c);
+            neighborColors[e.destination].insert(c);
         }
     }
     // Remap to 1..maxColor+1
@@ -0,0 +1,43 @@
+#include "edge_table.hpp"
+
+using namespace std;
+
+EdgeTable::EdgeTable(const Graph &graph)
+{
+    int n = graph.getVertexCount();
+    offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+        offsets[u + 1] = offsets[u] + graph.getDegree(u);
+    targets.resize(offsets[n]);
+    sources.resize(offsets[n]);
+    capacity.resize(offsets[n]);
+    for (int u = 0; u < n; ++u)
+    {
+        int id = offsets[u];
+        for (const Edge &e : graph.neighbors(u))
+        {
+            targets[id] = e.destination;
+            sources[id] = u;
+            capacity[id++] = e.weight;
+        }
+    }
+
+    // Counting sort of the ids by target; ids are visited in order, so each vertex's list is sorted
+    inOffsets.assign(n + 1, 0);
+    for (vertex_t v : targets)
+        inOffsets[v + 1]++;
+    for (int v = 0; v < n; ++v)
+        inOffsets[v + 1] += inOffsets[v];
+    vector<int> next(inOffsets.begin(), inOffsets.end() - 1);
+    inIds.resize(targets.size());
+    for (size_t id = 0; id < targets.size(); ++id)
+        inIds[next[targets[id]]++] = id;
+}
+
+int EdgeTable::findEdge(int source, int destination) const
+{
+    for (int id = offsets[source]; id < offsets[source + 1]; ++id)
+        if (targets[id] == (vertex_t)destination)
+            return id;
+    return -1;
+}
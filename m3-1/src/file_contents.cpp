@@ -0,0 +1,48 @@
+#include "file_contents.hpp"
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+FileContents::FileContents(const string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd != -1 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapped = static_cast<const char *>(mapping);
+            size = info.st_size;
+            opened = true;
+        }
+    }
+    if (fd != -1)
+        close(fd);
+    if (opened)
+        return;
+
+    ifstream file(filename, ios::binary);
+    if (!file.is_open())
+        return;
+    buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    size = buffer.size();
+    opened = true;
+}
+
+FileContents::~FileContents()
+{
+    if (mapped)
+        munmap(const_cast<char *>(mapped), size);
+}
+
+void FileContents::adviseSequential() const
+{
+    if (mapped)
+        madvise(const_cast<char *>(mapped), size, MADV_SEQUENTIAL);
+}
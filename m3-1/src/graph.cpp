@@ -1,281 +1,2091 @@
 #include "graph.hpp"
+#include "file_contents.hpp"
+#include "threads.hpp"
 #include <iostream>
+#include <fstream>
+#include <climits>
 #include <iomanip>
+#include <algorithm>
+#include <type_traits>
+#include <charconv>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
-Graph::Graph(bool directed, bool weighted, RepresentationType representation)
-    : directed(directed), weighted(weighted), representation(representation) {}
+// Approximate bytes of one list node (the edge plus its two links), used to size arenas
+static const size_t EDGE_NODE_BYTES = sizeof(Edge) + 2 * sizeof(void *);
 
-bool Graph::addVertex(string label)
+// Bytes writeVarint takes for `value`
+static int varintLength(uint64_t value)
 {
-    if (labelToIndex.count(label))
+    int length = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static void writeVarint(vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// HYBRID merges once its pending edits reach 1/MERGE_DIVISOR of the base arcs, or MIN_MERGE_EDITS
+// for small bases; addEdges batches at least that large go straight into a new base
+static const size_t MERGE_DIVISOR = 32;
+static const size_t MIN_MERGE_EDITS = 4096;
+
+// Appends rows in vertex order to a COMPRESSED graph's arrays, in the layout described in graph.hpp
+struct PackedRows
+{
+    vector<uint64_t> &offsets;
+    vector<uint8_t> &bytes;
+    int stride;
+    bool weighted;
+    vector<uint8_t> arcs;
+
+    PackedRows(vector<uint64_t> &offsets, vector<uint8_t> &bytes, int stride, bool weighted)
+        : offsets(offsets), bytes(bytes), stride(stride), weighted(weighted)
+    {
+        offsets.clear();
+        bytes.clear();
+    }
+
+    // `row` holds the vertex's {destination, weight} arcs sorted by destination
+    void append(int source, const vector<pair<vertex_t, weight_t>> &row)
+    {
+        arcs.clear();
+        int64_t previous = source;
+        for (size_t i = 0; i < row.size(); ++i)
+        {
+            int64_t gap = (int64_t)row[i].first - previous;
+            writeVarint(arcs, i == 0 ? (uint64_t)(gap * 2) ^ (uint64_t)(gap >> 63) : (uint64_t)gap);
+            previous = row[i].first;
+            if (weighted)
+            {
+                const uint8_t *raw = reinterpret_cast<const uint8_t *>(&row[i].second);
+                arcs.insert(arcs.end(), raw, raw + sizeof(weight_t));
+            }
+        }
+        if (source % stride == 0)
+            offsets.push_back(bytes.size());
+        writeVarint(bytes, arcs.size());
+        bytes.insert(bytes.end(), arcs.begin(), arcs.end());
+    }
+};
+
+// The views in labelToIndex point into other.indexToLabel, so they are re-keyed on this copy's labels
+VertexLabels::VertexLabels(const VertexLabels &other)
+    : identity(other.identity), numbering(other.numbering), position(other.position), indexToLabel(other.indexToLabel)
+{
+    labelToIndex.reserve(other.labelToIndex.size());
+    for (const auto &entry : other.labelToIndex)
+        labelToIndex.emplace(indexToLabel[entry.second], entry.second);
+}
+
+// Number named by `label` in identity mode: the canonical decimal form (to_string) of a non-negative
+// int, or -1 for anything else
+static int numericLabel(string_view label)
+{
+    int index;
+    const char *last = label.data() + label.size();
+    auto [end, error] = from_chars(label.data(), last, index);
+    if (error != errc() || end != last || label[0] < '0' || label[0] > '9' || (label.size() > 1 && label[0] == '0'))
+        return -1;
+    return index;
+}
+
+AdjacencyRow::AdjacencyRow(pmr::memory_resource *resource) : edges(resource) {}
+
+AdjacencyRow::AdjacencyRow(const AdjacencyRow &other, pmr::memory_resource *resource) : edges(other.edges, resource)
+{
+    if (!other.index.empty())
+        rebuildIndex();
+}
+
+void AdjacencyRow::rebuildIndex()
+{
+    index.clear();
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+        index.emplace(it->destination, it);
+}
+
+EdgeList::iterator AdjacencyRow::find(int destination, bool indexed)
+{
+    if (indexed)
+    {
+        auto it = index.find(destination);
+        return it == index.end() ? edges.end() : it->second;
+    }
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+        if (it->destination == (vertex_t)destination)
+            return it;
+    return edges.end();
+}
+
+EdgeList::const_iterator AdjacencyRow::find(int destination, bool indexed) const
+{
+    return const_cast<AdjacencyRow *>(this)->find(destination, indexed);
+}
+
+AdjacencyLists::SharedRow::SharedRow(shared_ptr<pmr::monotonic_buffer_resource> resource)
+    : arena(move(resource)), row(arena.get()) {}
+
+AdjacencyLists::SharedRow::SharedRow(shared_ptr<pmr::monotonic_buffer_resource> resource, const AdjacencyRow &other)
+    : arena(move(resource)), row(other, arena.get()) {}
+
+// The copy shares every row; only its own later edits get a (fresh) arena
+AdjacencyLists::AdjacencyLists(const AdjacencyLists &other) : rows(other.rows) {}
+
+AdjacencyLists &AdjacencyLists::operator=(const AdjacencyLists &other)
+{
+    if (this != &other)
+        *this = AdjacencyLists(other);
+    return *this;
+}
+
+const shared_ptr<pmr::monotonic_buffer_resource> &AdjacencyLists::currentArena()
+{
+    if (!arena)
+        arena = make_shared<pmr::monotonic_buffer_resource>();
+    return arena;
+}
+
+AdjacencyRow &AdjacencyLists::edit(size_t vertex)
+{
+    shared_ptr<SharedRow> &slot = rows[vertex];
+    if (slot.use_count() > 1)
+        slot = make_shared<SharedRow>(currentArena(), slot->row);
+    return slot->row;
+}
+
+void AdjacencyLists::reserve(size_t vertices, size_t arcs)
+{
+    rows.reserve(vertices);
+    if (rows.empty() && arcs > 0)
+        arena = make_shared<pmr::monotonic_buffer_resource>(arcs * EDGE_NODE_BYTES);
+}
+
+size_t AdjacencyLists::rowBytes(size_t rows)
+{
+    // make_shared puts each row next to its two reference counts
+    return rows * (sizeof(shared_ptr<SharedRow>) + sizeof(SharedRow) + 2 * sizeof(long));
+}
+
+void AdjacencyLists::addRow()
+{
+    rows.push_back(make_shared<SharedRow>(currentArena()));
+}
+
+Graph::Graph(bool directed, bool weighted, RepresentationType representation, bool indexEdges)
+    : directed(directed), weighted(weighted && representation != RepresentationType::BITMATRIX),
+      representation(representation == RepresentationType::AUTO ? RepresentationType::LIST : representation),
+      indexEdges(indexEdges)
+{
+    if (this->representation == RepresentationType::HYBRID)
+        csrOffsets.assign(1, 0);
+}
+
+// Copies the first `rows` rows of a flat row-major buffer into a wider stride, zero-filling the new
+// columns, with capacity reserved for `rowCapacity` rows so later rows are appended in place
+template <typename T>
+static void widenRows(vector<T> &cells, int rows, int oldStride, int newStride, int rowCapacity)
+{
+    vector<T> widened;
+    widened.reserve((size_t)newStride * rowCapacity);
+    widened.resize((size_t)newStride * rows, 0);
+    for (int r = 0; r < rows; ++r)
+        copy_n(cells.begin() + (size_t)r * oldStride, oldStride, widened.begin() + (size_t)r * newStride);
+    cells.swap(widened);
+}
+
+void Graph::reserve(int vertices, int edges)
+{
+    int rows = getVertexCount();
+    removed.reserve(vertices);
+    if (!labels->identity)
+        editLabels().labelToIndex.reserve(vertices);
+
+    if (representation == RepresentationType::MATRIX && vertices > matrixStride)
+    {
+        int stride = (vertices + 7) / 8 * 8;
+        widenRows(matrix, rows, matrixStride, stride, stride);
+        matrixStride = stride;
+    }
+    else if (representation == RepresentationType::BITMATRIX && vertices > bitWords * 64)
+    {
+        int words = (vertices + 63) / 64;
+        widenRows(bitMatrix, rows, bitWords, words, words * 64);
+        bitWords = words;
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        adjacencyList.reserve(vertices, (size_t)edges * (directed ? 1 : 2));
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        csrOffsets.reserve(vertices + 1);
+        deltaSlot.reserve(vertices);
+    }
+    else if (!frozen)
+    {
+        pendingEdges.reserve((size_t)edges * (directed ? 1 : 2));
+    }
+}
+
+bool Graph::addVertex(string_view label)
+{
+    if (frozen || getVertexIndex(label) != -1)
+        return false;
+    int index = getVertexCount();
+    if (!labels->identity || !labels->numbering.empty() || numericLabel(label) != index)
+    {
+        materializeLabels();
+        VertexLabels &names = editLabels();
+        names.indexToLabel.emplace_back(label);
+        names.labelToIndex.emplace(names.indexToLabel.back(), index);
+    }
+    appendVertexStorage();
+    inEdges.reset();
+    return true;
+}
+
+void Graph::materializeLabels()
+{
+    if (!labels->identity)
+        return;
+    VertexLabels &names = editLabels();
+    int n = getVertexCount();
+    names.labelToIndex.reserve(n);
+    for (int v = 0; v < n; ++v)
+    {
+        names.indexToLabel.push_back(getVertexLabel(v));
+        if (!removed[v])
+            names.labelToIndex.emplace(names.indexToLabel.back(), v);
+    }
+    names.identity = false;
+    vector<int>().swap(names.numbering);
+    vector<int>().swap(names.position);
+}
+
+void Graph::appendVertexStorage()
+{
+    int index = removed.size();
+    removed.push_back(0);
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        if (index >= matrixStride)
+            reserve(max(8, matrixStride * 2));
+        matrix.resize(matrix.size() + matrixStride, 0);
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        adjacencyList.addRow();
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        if (index >= bitWords * 64)
+            reserve(max(64, bitWords * 128));
+        bitMatrix.resize(bitMatrix.size() + bitWords, 0);
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        csrOffsets.push_back(csrOffsets.back());
+        deltaSlot.push_back(-1);
+    }
+}
+
+bool Graph::removeVertex(string_view label)
+{
+    int index = getVertexIndex(label);
+    if (index == -1)
         return false;
-    int index = indexToLabel.size();
-    labelToIndex[label] = index;
-    indexToLabel.push_back(label);
 
+    // Identity labels need no update: lookups already reject removed vertices
+    if (!labels->identity)
+        editLabels().labelToIndex.erase(label);
+    removed[index] = 1;
+    removedCount++;
+    inEdges.reset();
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        // A row and a column are the matrix's O(degree): clear both so no scan ever sees the vertex
+        int n = getVertexCount();
+        fill_n(&cell(index, 0), n, 0.0f);
+        for (int u = 0; u < n; ++u)
+            cell(u, index) = 0;
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        fill_n(bitMatrix.begin() + (size_t)index * bitWords, bitWords, 0);
+        for (size_t start = 0; start < bitMatrix.size(); start += bitWords)
+            bitMatrix[start + index / 64] &= ~(1ULL << (index % 64));
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        // Edges other vertices hold into this one stay until compact(); neighbors() skips them
+        AdjacencyRow &row = adjacencyList.edit(index);
+        row.edges.clear();
+        row.index.clear();
+    }
+    else if (representation == RepresentationType::HYBRID && deltaSlot[index] != -1)
+    {
+        // Its base row is skipped like a CSR row; edits to it are dropped
+        deltas[deltaSlot[index]] = DeltaRow();
+        deltaSlot[index] = -1;
+    }
+
+    return true;
+}
+
+vector<int> Graph::compact()
+{
+    int n = getVertexCount();
+    vector<int> newIndex(n, -1);
+    int live = 0;
+    for (int v = 0; v < n; ++v)
+        if (!removed[v])
+            newIndex[v] = live++;
+    if (removedCount == 0)
+        return newIndex;
+
+    renumber(newIndex);
+    return newIndex;
+}
+
+// Stable sort for the per-vertex ranges reorder() sorts, which are mostly a few elements long:
+// stable_sort would allocate a buffer on each of its V calls
+template <typename It, typename Less>
+static void stableSortShort(It first, It last, Less less)
+{
+    if (last - first > 32)
+    {
+        stable_sort(first, last, less);
+        return;
+    }
+    for (It i = first; i != last; ++i)
+        for (It j = i; j != first && less(*j, *(j - 1)); --j)
+            iter_swap(j, j - 1);
+}
+
+// Visiting order of the live vertices for reorder(). BFS and DFS start each component at its lowest
+// index; Cuthill-McKee starts it at a minimum-degree vertex and visits neighbors by increasing degree.
+static vector<int> reorderSequence(const Graph &graph, ReorderStrategy strategy)
+{
+    int n = graph.getVertexCount();
+    vector<int> sequence;
+    sequence.reserve(n);
+    vector<int> degree(n);
+    int maxDegree = 0;
+    for (int v = 0; v < n; ++v)
+    {
+        degree[v] = graph.isRemoved(v) ? 0 : graph.getDegree(v);
+        maxDegree = max(maxDegree, degree[v]);
+    }
+    auto byDegree = [&degree](int a, int b)
+    { return degree[a] < degree[b]; };
+
+    vector<int> roots;
+    roots.reserve(n);
+    if (strategy == ReorderStrategy::BFS || strategy == ReorderStrategy::DFS)
+    {
+        for (int v = 0; v < n; ++v)
+            if (!graph.isRemoved(v))
+                roots.push_back(v);
+    }
+    else
+    {
+        // Live vertices by degree, ascending for RCM and descending for DEGREE, ties by index (counting sort)
+        bool descending = strategy == ReorderStrategy::DEGREE;
+        vector<int> start(maxDegree + 2, 0);
+        for (int v = 0; v < n; ++v)
+            if (!graph.isRemoved(v))
+                start[(descending ? maxDegree - degree[v] : degree[v]) + 1]++;
+        for (int d = 0; d <= maxDegree; ++d)
+            start[d + 1] += start[d];
+        roots.resize(start[maxDegree + 1]);
+        for (int v = 0; v < n; ++v)
+            if (!graph.isRemoved(v))
+                roots[start[descending ? maxDegree - degree[v] : degree[v]]++] = v;
+        if (descending)
+            return roots;
+    }
+
+    vector<bool> visited(n, false);
+    vector<int> pending;
+    for (int root : roots)
+    {
+        if (visited[root])
+            continue;
+
+        if (strategy == ReorderStrategy::DFS)
+        {
+            // Preorder with an explicit stack; neighbors are pushed in reverse to pop in adjacency order
+            pending.assign(1, root);
+            while (!pending.empty())
+            {
+                int v = pending.back();
+                pending.pop_back();
+                if (visited[v])
+                    continue;
+                visited[v] = true;
+                sequence.push_back(v);
+                size_t mark = pending.size();
+                for (const Edge &e : graph.neighbors(v))
+                    if (!visited[e.destination])
+                        pending.push_back(e.destination);
+                reverse(pending.begin() + mark, pending.end());
+            }
+            continue;
+        }
+
+        // BFS and Cuthill-McKee: the sequence itself is the queue
+        size_t head = sequence.size();
+        visited[root] = true;
+        sequence.push_back(root);
+        while (head < sequence.size())
+        {
+            int v = sequence[head++];
+            size_t mark = sequence.size();
+            for (const Edge &e : graph.neighbors(v))
+            {
+                if (!visited[e.destination])
+                {
+                    visited[e.destination] = true;
+                    sequence.push_back(e.destination);
+                }
+            }
+            if (strategy == ReorderStrategy::RCM)
+                stableSortShort(sequence.begin() + mark, sequence.end(), byDegree);
+        }
+    }
+
+    if (strategy == ReorderStrategy::RCM)
+        reverse(sequence.begin(), sequence.end());
+    return sequence;
+}
+
+vector<int> Graph::reorder(ReorderStrategy strategy)
+{
+    vector<int> sequence = reorderSequence(*this, strategy);
+    vector<int> newIndex(getVertexCount(), -1);
+    for (size_t i = 0; i < sequence.size(); ++i)
+        newIndex[sequence[i]] = i;
+
+    renumber(newIndex);
+    return newIndex;
+}
+
+// Moves vertex v to newIndex[v] in every structure, dropping vertices mapped to -1. The live
+// vertices must map onto 0 .. live - 1.
+void Graph::renumber(const vector<int> &newIndex)
+{
+    if (representation == RepresentationType::HYBRID)
+        merge();
+    inEdges.reset();
+    int n = getVertexCount();
+    int live = n - removedCount;
+    vector<int> oldIndex(live);
+    for (int v = 0; v < n; ++v)
+        if (newIndex[v] != -1)
+            oldIndex[newIndex[v]] = v;
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        vector<weight_t> moved((size_t)live * matrixStride, 0);
+        for (int u = 0; u < live; ++u)
+            for (int v = 0; v < live; ++v)
+                moved[(size_t)u * matrixStride + v] = cell(oldIndex[u], oldIndex[v]);
+        matrix.swap(moved);
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        vector<uint64_t> packed((size_t)live * bitWords, 0);
+        for (int u = 0; u < n; ++u)
+        {
+            if (newIndex[u] == -1)
+                continue;
+            uint64_t *row = packed.data() + (size_t)newIndex[u] * bitWords;
+            for (const Edge &e : neighbors(u))
+                row[newIndex[e.destination] / 64] |= 1ULL << (newIndex[e.destination] % 64);
+        }
+        bitMatrix.swap(packed);
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        // Rebuilt in the new order in a fresh arena, so the edge nodes follow the new numbering in memory
+        size_t arcs = 0;
+        for (int u = 0; u < live; ++u)
+            arcs += adjacencyList[oldIndex[u]].edges.size();
+        AdjacencyLists rows;
+        rows.reserve(live, arcs);
+        for (int u = 0; u < live; ++u)
+        {
+            rows.addRow();
+            AdjacencyRow &row = rows.edit(u);
+            for (const Edge &e : neighbors(oldIndex[u]))
+                row.edges.push_back({(vertex_t)newIndex[e.destination], e.weight});
+            if (indexEdges)
+                row.rebuildIndex();
+        }
+        adjacencyList = move(rows);
+    }
+    else if (frozen || representation == RepresentationType::HYBRID)
+    {
+        // Rows are rebuilt in their new order and re-sorted, since destinations were renamed
+        vector<int> offsets(live + 1, 0);
+        vector<vertex_t> targets;
+        vector<weight_t> weights;
+        vector<pair<vertex_t, weight_t>> row;
+        vector<uint64_t> rowStarts;
+        vector<uint8_t> bytes;
+        PackedRows packed(rowStarts, bytes, PACKED_STRIDE, weighted);
+        bool compressed = representation == RepresentationType::COMPRESSED;
+        targets.reserve(csrTargets.size());
+        weights.reserve(csrWeights.size());
+        bytes.reserve(packedBytes.size());
+        for (int u = 0; u < live; ++u)
+        {
+            row.clear();
+            for (const Edge &e : neighbors(oldIndex[u]))
+                row.emplace_back(newIndex[e.destination], e.weight);
+            stableSortShort(row.begin(), row.end(), [](const auto &a, const auto &b)
+                            { return a.first < b.first; });
+            if (compressed)
+            {
+                packed.append(u, row);
+                continue;
+            }
+            for (const auto &[v, w] : row)
+            {
+                targets.push_back(v);
+                if (weighted)
+                    weights.push_back(w);
+            }
+            offsets[u + 1] = targets.size();
+        }
+        if (compressed)
+        {
+            packedOffsets.swap(rowStarts);
+            packedBytes.swap(bytes);
+        }
+        else
+        {
+            csrOffsets.swap(offsets);
+            csrTargets.swap(targets);
+            csrWeights.swap(weights);
+        }
+    }
+    else
+    {
+        vector<tuple<vertex_t, vertex_t, weight_t>> staged;
+        for (const auto &[u, v, w] : pendingEdges)
+            if (newIndex[u] != -1 && newIndex[v] != -1)
+                staged.emplace_back(newIndex[u], newIndex[v], w);
+        pendingEdges.swap(staged);
+    }
+
+    removed.assign(live, 0);
+    removedCount = 0;
+    if (representation == RepresentationType::HYBRID)
+        deltaSlot.assign(live, -1);
+
+    // Labels move with their vertices; identity labels only record each vertex's number
+    VertexLabels &names = editLabels();
+    if (names.identity)
+    {
+        vector<int> numbering(live);
+        for (int v = 0; v < live; ++v)
+            numbering[v] = names.numbering.empty() ? oldIndex[v] : names.numbering[oldIndex[v]];
+        names.position.assign(names.numbering.empty() ? n : names.position.size(), -1);
+        for (int v = 0; v < live; ++v)
+            names.position[numbering[v]] = v;
+        names.numbering.swap(numbering);
+        return;
+    }
+
+    deque<string> relabeled;
+    for (int v : oldIndex)
+        relabeled.push_back(move(names.indexToLabel[v]));
+    names.indexToLabel.swap(relabeled);
+    names.labelToIndex.clear();
+    for (int v = 0; v < live; ++v)
+        names.labelToIndex.emplace(names.indexToLabel[v], v);
+}
+
+// Bytes of a hash table with `buckets` buckets and `entries` nodes holding `entryBytes` each
+static size_t hashTableBytes(size_t buckets, size_t entries, size_t entryBytes)
+{
+    return buckets * sizeof(void *) + entries * (entryBytes + sizeof(void *));
+}
+
+static size_t labelBytes(const VertexLabels &names)
+{
+    size_t bytes = (names.numbering.capacity() + names.position.capacity()) * sizeof(int);
+    // Short labels live inside the string object itself
+    size_t inlineCapacity = string().capacity();
+    for (const string &label : names.indexToLabel)
+        bytes += sizeof(string) + (label.capacity() > inlineCapacity ? label.capacity() + 1 : 0);
+    // String-like keys also cache their hash in the node
+    bytes += hashTableBytes(names.labelToIndex.bucket_count(), names.labelToIndex.size(),
+                            sizeof(pair<const string_view, vertex_t>) + sizeof(size_t));
+    return bytes;
+}
+
+MemoryFootprint Graph::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.labels = labelBytes(*labels);
+    footprint.structure = removed.capacity();
+    size_t &cells = weighted ? footprint.weights : footprint.structure;
+
+    if (representation == RepresentationType::MATRIX)
+        cells += matrix.capacity() * sizeof(weight_t);
+    else if (representation == RepresentationType::BITMATRIX)
+        footprint.structure += bitMatrix.capacity() * sizeof(uint64_t);
+    else if (representation == RepresentationType::LIST)
+    {
+        size_t nodes = 0;
+        footprint.structure += AdjacencyLists::rowBytes(adjacencyList.size());
+        for (size_t v = 0; v < adjacencyList.size(); ++v)
+        {
+            const AdjacencyRow &row = adjacencyList[v];
+            nodes += row.edges.size();
+            footprint.structure += hashTableBytes(row.index.bucket_count(), row.index.size(),
+                                                  sizeof(pair<const int, EdgeList::iterator>));
+        }
+        footprint.structure += nodes * (EDGE_NODE_BYTES - sizeof(weight_t));
+        cells += nodes * sizeof(weight_t);
+    }
+    else if (representation == RepresentationType::COMPRESSED)
+    {
+        // Weights are stored inline with the gaps, one per arc
+        size_t arcs = 0;
+        for (int v = 0; v < getVertexCount(); ++v)
+            arcs += getDegree(v);
+        size_t bytes = packedOffsets.capacity() * sizeof(uint64_t) + packedBytes.capacity() +
+                       pendingEdges.capacity() * sizeof(pendingEdges[0]);
+        footprint.weights += weighted ? arcs * sizeof(weight_t) : 0;
+        footprint.structure += bytes - footprint.weights;
+    }
+    else
+    {
+        footprint.structure += csrOffsets.capacity() * sizeof(int) + csrTargets.capacity() * sizeof(vertex_t) +
+                               pendingEdges.capacity() * sizeof(pendingEdges[0]);
+        footprint.weights += csrWeights.capacity() * sizeof(weight_t);
+        // HYBRID edit buffers
+        footprint.structure += deltaSlot.capacity() * sizeof(int) + deltas.capacity() * sizeof(DeltaRow);
+        for (const DeltaRow &row : deltas)
+            footprint.structure += row.erased.capacity() * sizeof(vertex_t) + row.added.capacity() * sizeof(Edge);
+    }
+    if (const InEdges *index = inEdges.ready.load(memory_order_acquire))
+    {
+        footprint.structure += index->offsets.capacity() * sizeof(int) + index->sources.capacity() * sizeof(vertex_t);
+        footprint.weights += index->weights.capacity() * sizeof(weight_t);
+    }
+    return footprint;
+}
+
+size_t Graph::estimateFootprint(RepresentationType type, int vertices, size_t arcs, bool weighted, bool indexEdges)
+{
+    size_t n = vertices;
+    // Tombstone flags
+    size_t bytes = n;
+
+    if (type == RepresentationType::MATRIX)
+        bytes += n * ((n + 7) / 8 * 8) * sizeof(weight_t);
+    else if (type == RepresentationType::BITMATRIX)
+        bytes += n * ((n + 63) / 64) * sizeof(uint64_t);
+    else if (type == RepresentationType::CSR || type == RepresentationType::HYBRID)
+        bytes += (n + 1) * sizeof(int) + arcs * (sizeof(vertex_t) + (weighted ? sizeof(weight_t) : 0)) +
+                 (type == RepresentationType::HYBRID ? n : 0);
+    else if (type == RepresentationType::COMPRESSED)
+    {
+        // Gaps are sized as if neighbors were spread evenly over all vertices, which is the worst
+        // case for graphs whose numbering has any locality
+        size_t gap = arcs > 0 ? n * n / arcs : 0;
+        size_t rowBytes = n > 0 ? arcs * varintLength(gap) / n : 0;
+        bytes += (n / PACKED_STRIDE + 1) * sizeof(uint64_t) + n * varintLength(rowBytes) +
+                 arcs * (varintLength(gap) + (weighted ? sizeof(weight_t) : 0));
+    }
+    else
+    {
+        bytes += AdjacencyLists::rowBytes(n) + arcs * EDGE_NODE_BYTES;
+        // One index entry per distinct destination, and about one bucket per entry
+        if (indexEdges)
+            bytes += hashTableBytes(arcs, arcs, sizeof(pair<const int, EdgeList::iterator>));
+    }
+    return bytes;
+}
+
+RepresentationType Graph::chooseRepresentation(int vertices, size_t arcs, bool weighted, size_t budget, bool indexEdges)
+{
+    if (indexEdges)
+        return RepresentationType::LIST;
+
+    // A weighted matrix drops 0-weight arcs (a 0 cell is no edge) and keeps one weight per pair, so it is
+    // never chosen for weighted graphs, whose algorithm results would change
+    size_t sparseBytes = estimateFootprint(RepresentationType::CSR, vertices, arcs, weighted);
+    if (!weighted)
+    {
+        size_t denseBytes = estimateFootprint(RepresentationType::BITMATRIX, vertices, arcs, weighted);
+        if (denseBytes <= 2 * sparseBytes && (budget == 0 || denseBytes <= budget))
+            return RepresentationType::BITMATRIX;
+    }
+    if (budget > 0 && sparseBytes > budget &&
+        estimateFootprint(RepresentationType::COMPRESSED, vertices, arcs, weighted) <= budget)
+        return RepresentationType::COMPRESSED;
+    return RepresentationType::CSR;
+}
+
+bool Graph::isRemoved(int vertex) const
+{
+    return removed[vertex];
+}
+
+bool Graph::addEdge(int source, int destination, weight_t weight)
+{
+    if (source >= getVertexCount() || destination >= getVertexCount() || removed[source] || removed[destination])
+        return false;
+    weight_t w = (weighted ? weight : 1);
+    inEdges.reset();
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        cell(source, destination) = w;
+        if (!directed)
+            cell(destination, source) = w;
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        AdjacencyRow &row = adjacencyList.edit(source);
+        row.edges.push_back({(vertex_t)destination, w});
+        if (indexEdges)
+            row.index.emplace(destination, prev(row.edges.end()));
+        if (!directed)
+        {
+            AdjacencyRow &reverse = adjacencyList.edit(destination);
+            reverse.edges.push_back({(vertex_t)source, w});
+            if (indexEdges)
+                reverse.index.emplace(source, prev(reverse.edges.end()));
+        }
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        bitMatrix[(size_t)source * bitWords + destination / 64] |= 1ULL << (destination % 64);
+        if (!directed)
+            bitMatrix[(size_t)destination * bitWords + source / 64] |= 1ULL << (source % 64);
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        addDeltaArc(source, destination, w);
+        if (!directed)
+            addDeltaArc(destination, source, w);
+        mergeIfLarge();
+    }
+    else
+    {
+        if (frozen)
+            return false;
+        pendingEdges.emplace_back(source, destination, w);
+        if (!directed)
+            pendingEdges.emplace_back(destination, source, w);
+    }
+
+    return true;
+}
+
+bool Graph::addEdges(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges)
+{
+    // Compared unsigned so negative ids (for signed vertex_t) wrap past n and are rejected too
+    int n = getVertexCount();
+    using Id = make_unsigned_t<vertex_t>;
+    for (const auto &[u, v, w] : edges)
+        if ((Id)u >= (Id)n || (Id)v >= (Id)n || removed[u] || removed[v])
+            return false;
+    inEdges.reset();
+
+    if (representation == RepresentationType::HYBRID && edges.size() >= MIN_MERGE_EDITS)
+    {
+        rebuildBase(edges);
+        return true;
+    }
+
+    if (representation != RepresentationType::LIST)
+    {
+        if (frozen)
+            return false;
+        if (representation == RepresentationType::CSR || representation == RepresentationType::COMPRESSED)
+            pendingEdges.reserve(pendingEdges.size() + edges.size() * (directed ? 1 : 2));
+        for (const auto &[u, v, w] : edges)
+            addEdge(u, v, w);
+        return true;
+    }
+
+    auto append = [&](int source, int destination, weight_t w)
+    {
+        AdjacencyRow &row = adjacencyList.edit(source);
+        row.edges.push_back({(vertex_t)destination, weighted ? w : 1});
+        if (indexEdges)
+            row.index.emplace(destination, prev(row.edges.end()));
+    };
+
+    // Grouping by source costs O(V), which a batch much smaller than the graph (as the loader streams
+    // them) would pay over and over, so such batches are appended in input order; rows end up the same
+    if (edges.size() * (directed ? 1 : 2) < (size_t)n / 4)
+    {
+        for (const auto &[u, v, w] : edges)
+        {
+            append(u, v, w);
+            if (!directed)
+                append(v, u, w);
+        }
+        return true;
+    }
+
+    // Counting sort of the arcs by source (arc 2i is edge i, arc 2i + 1 its undirected mirror),
+    // which keeps each row in input order, exactly as repeated addEdge calls would
+    vector<int> start(n + 1, 0);
+    for (const auto &[u, v, w] : edges)
+    {
+        start[u + 1]++;
+        if (!directed)
+            start[v + 1]++;
+    }
+    for (int i = 0; i < n; ++i)
+        start[i + 1] += start[i];
+
+    vector<int> arcs(start[n]);
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        arcs[start[get<0>(edges[i])]++] = 2 * i;
+        if (!directed)
+            arcs[start[get<1>(edges[i])]++] = 2 * i + 1;
+    }
+
+    for (int arc : arcs)
+    {
+        const auto &[u, v, w] = edges[arc / 2];
+        append(arc % 2 ? v : u, arc % 2 ? u : v, w);
+    }
+    return true;
+}
+
+bool Graph::removeEdge(int source, int destination)
+{
+    if (representation == RepresentationType::CSR || representation == RepresentationType::COMPRESSED || source >= getVertexCount() || destination >= getVertexCount() ||
+        removed[source] || removed[destination])
+        return false;
+    inEdges.reset();
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        cell(source, destination) = 0;
+        if (!directed)
+            cell(destination, source) = 0;
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        bitMatrix[(size_t)source * bitWords + destination / 64] &= ~(1ULL << (destination % 64));
+        if (!directed)
+            bitMatrix[(size_t)destination * bitWords + source / 64] &= ~(1ULL << (source % 64));
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        eraseDeltaArc(source, destination);
+        if (!directed)
+            eraseDeltaArc(destination, source);
+        mergeIfLarge();
+    }
+    else
+    {
+        AdjacencyRow &row = adjacencyList.edit(source);
+        row.edges.remove_if([destination](Edge e)
+                            { return e.destination == (vertex_t)destination; });
+        row.index.erase(destination);
+        if (!directed)
+        {
+            AdjacencyRow &reverse = adjacencyList.edit(destination);
+            reverse.edges.remove_if([source](Edge e)
+                                    { return e.destination == (vertex_t)source; });
+            reverse.index.erase(source);
+        }
+    }
+
+    return true;
+}
+
+bool Graph::edgeExists(int source, int destination) const
+{
+    if (removedCount > 0 && (removed[source] || removed[destination]))
+        return false;
+    if (representation == RepresentationType::MATRIX)
+        return cell(source, destination) != 0;
+    else if (representation == RepresentationType::CSR)
+        return csrFind(source, destination) != -1;
+    else if (representation == RepresentationType::BITMATRIX)
+        return edgeWeight(source, destination) != 0;
+    else if (representation == RepresentationType::COMPRESSED)
+    {
+        weight_t weight;
+        return packedFind(source, destination, weight);
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        weight_t weight;
+        return hybridFind(source, destination, weight);
+    }
+    else
+        return adjacencyList[source].find(destination, indexEdges) != adjacencyList[source].edges.end();
+}
+
+weight_t Graph::edgeWeight(int source, int destination) const
+{
+    if (removedCount > 0 && (removed[source] || removed[destination]))
+        return 0;
+    if (representation == RepresentationType::MATRIX)
+        return cell(source, destination);
+    else if (representation == RepresentationType::CSR)
+    {
+        int pos = csrFind(source, destination);
+        if (pos == -1)
+            return 0;
+        return weighted ? csrWeights[pos] : 1;
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+        return (bitMatrix[(size_t)source * bitWords + destination / 64] >> (destination % 64)) & 1ULL;
+    else if (representation == RepresentationType::COMPRESSED)
+    {
+        weight_t weight;
+        return packedFind(source, destination, weight) ? weight : 0;
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        weight_t weight;
+        return hybridFind(source, destination, weight) ? weight : 0;
+    }
+    else
+    {
+        auto it = adjacencyList[source].find(destination, indexEdges);
+        return it == adjacencyList[source].edges.end() ? 0 : it->weight;
+    }
+}
+
+NeighborRange Graph::neighbors(int vertex) const
+{
+    NeighborRange range;
+    range.first.kind = range.last.kind = representation;
+
+    if (representation == RepresentationType::MATRIX)
+    {
+        range.first.row = range.last.row = matrixRow(vertex);
+        range.first.end = range.last.end = range.last.index = getVertexCount();
+        range.first.skipEmptyCells();
+    }
+    else if (representation == RepresentationType::LIST)
+    {
+        range.first.node = adjacencyList[vertex].edges.begin();
+        range.first.nodeEnd = range.last.node = adjacencyList[vertex].edges.end();
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        range.first.words = range.last.words = bitRow(vertex);
+        range.first.end = range.last.end = range.last.index = bitWords;
+        if (bitWords > 0)
+        {
+            range.first.bits = range.first.words[0];
+            range.first.skipEmptyWords();
+        }
+    }
+    else if ((representation == RepresentationType::CSR && frozen) || representation == RepresentationType::HYBRID)
+    {
+        // A removed vertex's CSR row stays in place, so it is skipped here
+        range.first.target = csrTargets.data() + csrOffsets[removed[vertex] ? vertex + 1 : vertex];
+        range.first.targetEnd = range.last.target = csrTargets.data() + csrOffsets[vertex + 1];
+        if (weighted)
+            range.first.weight = csrWeights.data() + csrOffsets[removed[vertex] ? vertex + 1 : vertex];
+        if (representation == RepresentationType::HYBRID && deltaSlot[vertex] == -1)
+            range.first.kind = range.last.kind = RepresentationType::CSR;
+        else if (representation == RepresentationType::HYBRID)
+        {
+            const DeltaRow &row = deltas[deltaSlot[vertex]];
+            range.first.erased = row.erased.data();
+            range.first.erasedEnd = row.erased.data() + row.erased.size();
+            range.first.extra = row.added.data();
+            range.first.extraEnd = range.last.extra = range.last.extraEnd = row.added.data() + row.added.size();
+            range.first.skipErased();
+        }
+    }
+    else if (representation == RepresentationType::COMPRESSED && frozen)
+    {
+        const uint8_t *end;
+        const uint8_t *row = packedRow(vertex, end);
+        range.first.packed = removed[vertex] ? end : row;
+        range.first.packedEnd = range.last.packed = end;
+        range.first.packedWeights = weighted;
+        range.first.decoded.destination = vertex;
+        if (range.first.packed != end)
+            range.first.decode(true);
+    }
+
+    if (removedCount > 0 && representation != RepresentationType::MATRIX && representation != RepresentationType::BITMATRIX)
+    {
+        range.first.dead = removed.data();
+        range.first.skipRemoved();
+    }
+    return range;
+}
+
+int Graph::getDegree(int vertex) const
+{
+    if (representation == RepresentationType::MATRIX)
+    {
+        int n = getVertexCount();
+        const weight_t *row = matrixRow(vertex);
+        int degree = 0;
+        for (int v = 0; v < n; ++v)
+            degree += (row[v] != 0);
+        return degree;
+    }
+    if (representation == RepresentationType::COMPRESSED || (representation == RepresentationType::HYBRID && deltaSlot[vertex] != -1) ||
+        (removedCount > 0 && representation != RepresentationType::BITMATRIX))
+    {
+        // Edges into tombstoned vertices are still stored, packed rows record no arc count and edited
+        // rows overlay the base, so count what neighbors() yields
+        NeighborRange range = neighbors(vertex);
+        int degree = 0;
+        for (auto it = range.begin(); it != range.end(); ++it)
+            degree++;
+        return degree;
+    }
+    if (representation == RepresentationType::LIST)
+        return adjacencyList[vertex].edges.size();
+    if (representation == RepresentationType::BITMATRIX)
+    {
+        int degree = 0;
+        const uint64_t *row = bitRow(vertex);
+        for (int w = 0; w < bitWords; ++w)
+            degree += __builtin_popcountll(row[w]);
+        return degree;
+    }
+    return csrOffsets.empty() ? 0 : csrOffsets[vertex + 1] - csrOffsets[vertex];
+}
+
+NeighborRange Graph::inNeighbors(int vertex) const
+{
+    if (!directed)
+        return neighbors(vertex);
+    const InEdges &index = reverseIndex();
+
+    // Iterated like a CSR row; removed vertices were left out when the index was built
+    NeighborRange range;
+    range.first.kind = range.last.kind = RepresentationType::CSR;
+    range.first.target = index.sources.data() + index.offsets[vertex];
+    range.first.targetEnd = range.last.target = index.sources.data() + index.offsets[vertex + 1];
+    if (weighted)
+        range.first.weight = index.weights.data() + index.offsets[vertex];
+    return range;
+}
+
+int Graph::getInDegree(int vertex) const
+{
+    if (!directed)
+        return getDegree(vertex);
+    const InEdges &index = reverseIndex();
+    return index.offsets[vertex + 1] - index.offsets[vertex];
+}
+
+const Graph::InEdges &Graph::reverseIndex() const
+{
+    if (const InEdges *index = inEdges.ready.load(memory_order_acquire))
+        return *index;
+    // Concurrent readers of one graph may all find it missing: each builds one and the first stored is
+    // kept. It then lives in inEdges until an edit, which readers never make, drops it.
+    shared_ptr<const InEdges> index = atomic_load(&inEdges.index);
+    if (!index)
+    {
+        shared_ptr<const InEdges> built = buildInEdges();
+        index = atomic_compare_exchange_strong(&inEdges.index, &index, built) ? built : index;
+    }
+    inEdges.ready.store(index.get(), memory_order_release);
+    return *index;
+}
+
+shared_ptr<const Graph::InEdges> Graph::buildInEdges() const
+{
+    // Counting sort of the out-edges by destination; sources are visited in order, so each row comes out sorted
+    int n = getVertexCount();
+    auto index = make_shared<InEdges>();
+    index->offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+        for (const Edge &e : neighbors(u))
+            index->offsets[e.destination + 1]++;
+    for (int v = 0; v < n; ++v)
+        index->offsets[v + 1] += index->offsets[v];
+
+    vector<int> next(index->offsets.begin(), index->offsets.end() - 1);
+    index->sources.resize(index->offsets[n]);
+    if (weighted)
+        index->weights.resize(index->offsets[n]);
+    for (int u = 0; u < n; ++u)
+        for (const Edge &e : neighbors(u))
+        {
+            int pos = next[e.destination]++;
+            index->sources[pos] = u;
+            if (weighted)
+                index->weights[pos] = e.weight;
+        }
+    return index;
+}
+
+void Graph::printGraph()
+{
     if (representation == RepresentationType::MATRIX)
     {
-        for (auto &row : matrix)
-            row.push_back(0);
-        matrix.push_back(vector<float>(index + 1, 0));
+        cout << "Adjacency Matrix:\n      ";
+        cout << setw(4) << "|";
+        for (int i = 0; i < getVertexCount(); ++i)
+            if (!removed[i])
+                cout << setw(4) << getVertexLabel(i) << setw(4) << "|";
+        cout << endl;
+
+        cout << string(8, '-') << "-+-";
+        cout << string(8 * (getVertexCount() - removedCount), '-') << endl;
+
+        for (int i = 0; i < getVertexCount(); ++i)
+        {
+            if (removed[i])
+                continue;
+            cout << setw(8) << getVertexLabel(i);
+            cout << " |";
+            for (int j = 0; j < getVertexCount(); ++j)
+                if (!removed[j])
+                    cout << setw(4) << cell(i, j) << setw(4) << "|";
+            cout << endl;
+        }
+    }
+    else if (representation == RepresentationType::BITMATRIX)
+    {
+        cout << "Bit Matrix:\n";
+        for (int i = 0; i < getVertexCount(); ++i)
+        {
+            if (removed[i])
+                continue;
+            cout << setw(8) << getVertexLabel(i) << " |";
+            for (int j = 0; j < getVertexCount(); ++j)
+                if (!removed[j])
+                    cout << ((bitRow(i)[j / 64] >> (j % 64)) & 1ULL);
+            cout << endl;
+        }
+    }
+    else if (representation != RepresentationType::LIST)
+    {
+        cout << (representation == RepresentationType::CSR          ? "Compressed Sparse Row:\n"
+                 : representation == RepresentationType::COMPRESSED ? "Compressed Adjacency (delta + varint):\n"
+                                                                    : "Hybrid (CSR base + edits):\n");
+        cout << "{Origin}({Destination}, {Weight})\n";
+        for (int i = 0; i < getVertexCount(); i++)
+        {
+            if (removed[i])
+                continue;
+            cout << getVertexLabel(i);
+            for (const Edge &e : neighbors(i))
+                cout << "(" << getVertexLabel(e.destination) << ", " << e.weight << ") ";
+            cout << endl;
+        }
     }
     else
     {
-        adjacencyList.emplace_back();
+        cout << "Adjacency List:\n";
+        cout << "{Origin}({Destination}, {Weight})\n";
+        for (size_t i = 0; i < adjacencyList.size(); i++)
+        {
+            if (removed[i])
+                continue;
+            cout << getVertexLabel(i);
+            for (const Edge &e : neighbors(i))
+                cout << "(" << getVertexLabel(e.destination) << ", " << e.weight << ") ";
+            cout << endl;
+        }
+    }
+    cout << endl;
+}
+
+int Graph::getVertexCount() const
+{
+    return removed.size();
+}
+
+int Graph::getVertexIndex(string_view label) const
+{
+    if (labels->identity)
+    {
+        int number = numericLabel(label);
+        const vector<int> &position = labels->position;
+        int index = position.empty() || number == -1 ? number : number < (int)position.size() ? position[number] : -1;
+        return index != -1 && index < getVertexCount() && !removed[index] ? index : -1;
     }
+    auto it = labels->labelToIndex.find(label);
+    return it == labels->labelToIndex.end() ? -1 : it->second;
+}
 
-    return true;
+VertexLabels &Graph::editLabels()
+{
+    if (labels.use_count() > 1)
+        labels = make_shared<VertexLabels>(*labels);
+    return *labels;
 }
 
-bool Graph::removeVertex(string label)
+string Graph::getVertexLabel(int index) const
 {
-    if (!labelToIndex.count(label))
-        return false;
+    if (labels->identity)
+        return to_string(labels->numbering.empty() ? index : labels->numbering[index]);
+    return labels->indexToLabel[index];
+}
+
+bool Graph::isWeighted() const
+{
+    return weighted;
+}
+
+bool Graph::isDirected() const
+{
+    return directed;
+}
+
+Graph Graph::copy() const
+{
+    // Labels and LIST rows are shared copy-on-write, one row at a time, so copying a LIST graph costs
+    // O(V) shared_ptr copies and no edge copies; the other representations' arrays and the tombstone
+    // flags are copied by value, except arrays still viewing a binary file, which are shared
+    Graph new_graph = *this;
+    return new_graph;
+}
 
-    int index = labelToIndex[label];
-    labelToIndex.erase(label);
-    indexToLabel.erase(indexToLabel.begin() + index);
+weight_t Graph::getCapacity(int u, int v) const
+{
+    return edgeWeight(u, v);
+}
 
+void Graph::addFlow(int u, int v, weight_t delta)
+{
+    inEdges.reset();
     if (representation == RepresentationType::MATRIX)
     {
-        matrix.erase(matrix.begin() + index);
-        for (auto &row : matrix)
-            row.erase(row.begin() + index);
+        cell(u, v) += delta;
+    }
+    else if (representation == RepresentationType::CSR)
+    {
+        // The CSR structure is fixed, so only the weight of an existing edge can change
+        int pos = csrFind(u, v);
+        if (pos != -1 && weighted)
+            csrWeights.edit(pos) += delta;
+    }
+    else if (representation == RepresentationType::BITMATRIX || representation == RepresentationType::COMPRESSED)
+    {
+        // Bits carry no capacity to adjust, and packed rows cannot change
+        return;
+    }
+    else if (representation == RepresentationType::HYBRID)
+    {
+        // A base arc keeps its slot, so only its weight changes; anything else goes to the edit buffer
+        int pos = csrFind(u, v);
+        DeltaRow *row = deltaSlot[u] != -1 ? &deltas[deltaSlot[u]] : nullptr;
+        if (pos != -1 && !(row && binary_search(row->erased.begin(), row->erased.end(), (vertex_t)v)))
+        {
+            if (weighted)
+                csrWeights.edit(pos) += delta;
+            return;
+        }
+        if (row)
+            for (Edge &e : row->added)
+                if (e.destination == (vertex_t)v)
+                {
+                    e.weight += delta;
+                    return;
+                }
+        addDeltaArc(u, v, delta);
+        mergeIfLarge();
     }
     else
     {
-        adjacencyList.erase(adjacencyList.begin() + index);
-        for (auto &edges : adjacencyList)
+        AdjacencyRow &row = adjacencyList.edit(u);
+        auto it = row.find(v, indexEdges);
+        if (it != row.edges.end())
         {
-            edges.remove_if([index](Edge e)
-                            { return e.destination == index; });
-            for (auto &e : edges)
-                if (e.destination > index)
-                    e.destination--;
+            it->weight += delta;
+            return;
         }
+        // Se não existir, cria uma nova
+        row.edges.push_back({(vertex_t)v, delta});
+        if (indexEdges)
+            row.index.emplace(v, prev(row.edges.end()));
     }
-
-    for (auto &pair : labelToIndex)
-        if (pair.second > index)
-            pair.second--;
-
-    return true;
 }
 
-bool Graph::addEdge(int source, int destination, float weight)
+vector<tuple<vertex_t, vertex_t, weight_t>> Graph::getEdges() const
 {
-    if (source >= getVertexCount() || destination >= getVertexCount())
-        return false;
-    float w = (weighted ? weight : 1.0f);
-
+    vector<tuple<vertex_t, vertex_t, weight_t>> edges;
     if (representation == RepresentationType::MATRIX)
     {
-        matrix[source][destination] = w;
-        if (!directed)
-            matrix[destination][source] = w;
+        for (int u = 0; u < getVertexCount(); ++u)
+        {
+            for (int v = 0; v < getVertexCount(); ++v)
+            {
+                if (cell(u, v) > 0)
+                    edges.emplace_back(u, v, cell(u, v));
+            }
+        }
     }
     else
     {
-        adjacencyList[source].push_back({destination, w});
-        if (!directed)
-            adjacencyList[destination].push_back({source, w});
+        // neighbors() already hides edges into removed vertices
+        for (int u = 0; u < getVertexCount(); ++u)
+        {
+            for (const Edge &e : neighbors(u))
+            {
+                if (e.weight > 0)
+                    edges.emplace_back(u, e.destination, e.weight);
+            }
+        }
+    }
+    return edges;
+}
+
+RepresentationType Graph::getRepresentation() const
+{
+    return representation;
+}
+
+void Graph::finalize()
+{
+    if (representation == RepresentationType::HYBRID)
+    {
+        merge();
+        return;
     }
+    if ((representation != RepresentationType::CSR && representation != RepresentationType::COMPRESSED) || frozen)
+        return;
+    inEdges.reset();
+
+    // pendingEdges already holds the mirrored arcs and only live endpoints at the time they were added
+    buildCsrArrays(pendingEdges, false, false, CsrBuildOptions());
+    vector<tuple<vertex_t, vertex_t, weight_t>>().swap(pendingEdges);
+    if (representation == RepresentationType::COMPRESSED)
+        packCsrArrays();
+    frozen = true;
+}
 
+bool Graph::buildFromEdges(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges, const CsrBuildOptions &options)
+{
+    bool empty = representation == RepresentationType::HYBRID ? csrTargets.empty() && deltaEdits == 0
+                                                               : !frozen && pendingEdges.empty();
+    if ((representation != RepresentationType::CSR && representation != RepresentationType::COMPRESSED &&
+         representation != RepresentationType::HYBRID) ||
+        !empty || !buildCsrArrays(edges, !directed, true, options))
+        return false;
+    inEdges.reset();
+    vector<tuple<vertex_t, vertex_t, weight_t>>().swap(pendingEdges);
+    if (representation == RepresentationType::COMPRESSED)
+        packCsrArrays();
+    frozen = representation != RepresentationType::HYBRID;
     return true;
 }
 
-bool Graph::removeEdge(int source, int destination)
+bool Graph::buildFromStream(const function<bool(const EdgeSink &)> &readEdges)
 {
-    if (source >= getVertexCount() || destination >= getVertexCount())
+    bool empty = representation == RepresentationType::HYBRID ? csrTargets.empty() && deltaEdits == 0
+                                                               : !frozen && pendingEdges.empty();
+    if ((representation != RepresentationType::CSR && representation != RepresentationType::COMPRESSED &&
+         representation != RepresentationType::HYBRID) ||
+        !empty)
         return false;
 
-    if (representation == RepresentationType::MATRIX)
+    // Pass 1: degrees, in offsets[u + 1]
+    int n = getVertexCount();
+    bool mirror = !directed;
+    using Id = make_unsigned_t<vertex_t>;
+    vector<int> offsets(n + 1, 0);
+    size_t total = 0;
+    bool valid = true;
+    bool counted = readEdges([&](const vector<tuple<vertex_t, vertex_t, weight_t>> &batch)
+                             {
+        for (const auto &[u, v, w] : batch)
+        {
+            if (!valid || (Id)u >= (Id)n || (Id)v >= (Id)n || removed[u] || removed[v])
+            {
+                valid = false;
+                return;
+            }
+            offsets[u + 1]++;
+            if (mirror)
+                offsets[v + 1]++;
+            total += mirror ? 2 : 1;
+        } });
+    if (!counted || !valid || total > (size_t)INT_MAX)
+        return false;
+    for (int u = 0; u < n; ++u)
+        offsets[u + 1] += offsets[u];
+
+    // Pass 2: every arc goes to the next free slot of its row, in input order
+    vector<int> next(offsets.begin(), offsets.end() - 1);
+    vector<vertex_t> targets(total);
+    vector<weight_t> weights(weighted ? total : 0);
+    auto place = [&](int source, int target, weight_t weight)
     {
-        matrix[source][destination] = 0;
-        if (!directed)
-            matrix[destination][source] = 0;
-    }
-    else
+        if ((Id)source >= (Id)n || next[source] == offsets[source + 1])
+            return false;
+        targets[next[source]] = target;
+        if (weighted)
+            weights[next[source]] = weight;
+        next[source]++;
+        return true;
+    };
+    bool placed = readEdges([&](const vector<tuple<vertex_t, vertex_t, weight_t>> &batch)
+                            {
+        for (const auto &[u, v, w] : batch)
+            valid = valid && place(u, v, w) && (!mirror || place(v, u, w)); });
+    for (int u = 0; u < n && valid; ++u)
+        valid = next[u] == offsets[u + 1];
+    if (!placed || !valid)
+        return false;
+    vector<int>().swap(next);
+
+    // Rows are stably sorted by destination, as buildCsrArrays sorts them; rows already in order (as in
+    // files sorted by edge) are only checked
+    int threads = (int)max<size_t>(1, min<size_t>(thread::hardware_concurrency(), total / 65536));
+    onThreads(threads, [&](int t)
+              {
+        vector<pair<vertex_t, weight_t>> row;
+        for (int u = (int)((size_t)n * t / threads); u < (int)((size_t)n * (t + 1) / threads); ++u)
+        {
+            vertex_t *first = targets.data() + offsets[u];
+            vertex_t *last = targets.data() + offsets[u + 1];
+            if (is_sorted(first, last))
+                continue;
+            row.clear();
+            for (int pos = offsets[u]; pos < offsets[u + 1]; ++pos)
+                row.emplace_back(targets[pos], weighted ? weights[pos] : 1);
+            stableSortShort(row.begin(), row.end(), [](const auto &a, const auto &b)
+                            { return a.first < b.first; });
+            for (int pos = offsets[u]; pos < offsets[u + 1]; ++pos)
+            {
+                targets[pos] = row[pos - offsets[u]].first;
+                if (weighted)
+                    weights[pos] = row[pos - offsets[u]].second;
+            }
+        } });
+
+    csrOffsets.swap(offsets);
+    csrTargets.swap(targets);
+    csrWeights.swap(weights);
+    inEdges.reset();
+    vector<tuple<vertex_t, vertex_t, weight_t>>().swap(pendingEdges);
+    if (representation == RepresentationType::COMPRESSED)
+        packCsrArrays();
+    frozen = representation != RepresentationType::HYBRID;
+    return true;
+}
+
+bool Graph::buildCsrArrays(const vector<tuple<vertex_t, vertex_t, weight_t>> &edges, bool mirror, bool validate,
+                           const CsrBuildOptions &options)
+{
+    int n = getVertexCount();
+    size_t count = edges.size();
+    int threads = options.threads;
+    if (threads <= 0)
+        threads = (int)max<size_t>(1, min<size_t>(thread::hardware_concurrency(), count / 65536));
+    // Sources are split into contiguous buckets, many per thread so that skewed degrees still balance
+    int bucketCount = max(1, min(n, threads * 64));
+    int bucketSize = max(1, (n + bucketCount - 1) / bucketCount);
+    auto slice = [&](int t)
+    { return make_pair(count * t / threads, count * (t + 1) / threads); };
+
+    // Pass 1: every thread counts its slice's arcs per bucket
+    using Id = make_unsigned_t<vertex_t>;
+    vector<size_t> next((size_t)threads * bucketCount, 0);
+    vector<char> invalid(threads, 0);
+    onThreads(threads, [&](int t)
+              {
+        size_t *counts = &next[(size_t)t * bucketCount];
+        auto [first, last] = slice(t);
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto &[u, v, w] = edges[i];
+            if (validate && ((Id)u >= (Id)n || (Id)v >= (Id)n || removed[u] || removed[v]))
+            {
+                invalid[t] = 1;
+                return;
+            }
+            if (options.dropSelfLoops && u == v)
+                continue;
+            counts[u / bucketSize]++;
+            if (mirror)
+                counts[v / bucketSize]++;
+        } });
+    if (find(invalid.begin(), invalid.end(), 1) != invalid.end())
+        return false;
+
+    // Bucket-major prefix sum: within a bucket, each thread's arcs follow those of the threads before it,
+    // so the arcs stay in input order
+    vector<size_t> bucketStart(bucketCount + 1, 0);
+    size_t total = 0;
+    for (int b = 0; b < bucketCount; ++b)
     {
-        adjacencyList[source].remove_if([destination](Edge e)
-                                        { return e.destination == destination; });
-        if (!directed)
-            adjacencyList[destination].remove_if([source](Edge e)
-                                                 { return e.destination == source; });
+        bucketStart[b] = total;
+        for (int t = 0; t < threads; ++t)
+            total += exchange(next[(size_t)t * bucketCount + b], total);
     }
+    bucketStart[bucketCount] = total;
+
+    // Pass 2: every thread scatters its slice's arcs into bucket order (arc 2i is edge i, 2i + 1 its mirror)
+    struct Arc
+    {
+        vertex_t source;
+        vertex_t target;
+        weight_t weight;
+    };
+    vector<Arc> staged(total);
+    onThreads(threads, [&](int t)
+              {
+        size_t *slot = &next[(size_t)t * bucketCount];
+        auto [first, last] = slice(t);
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto &[u, v, w] = edges[i];
+            if (options.dropSelfLoops && u == v)
+                continue;
+            weight_t weight = weighted ? w : 1;
+            staged[slot[u / bucketSize]++] = {u, v, weight};
+            if (mirror)
+                staged[slot[v / bucketSize]++] = {v, u, weight};
+        } });
+
+    // Pass 3: every bucket, taken by whichever thread is free, is counting-sorted by source in place, each
+    // row then stably by target and cut down to its first arc per target when asked. Degrees are kept in
+    // offsets[u + 1] until pass 4.
+    vector<int> offsets(n + 1, 0);
+    vector<size_t> kept(bucketCount, 0);
+    atomic<int> nextBucket(0);
+    onThreads(threads, [&](int)
+              {
+        vector<Arc> sorted;
+        vector<size_t> rowEnd;
+        for (int b; (b = nextBucket++) < bucketCount;)
+        {
+            int lo = min(n, b * bucketSize);
+            int hi = min(n, lo + bucketSize);
+            Arc *first = staged.data() + bucketStart[b];
+            Arc *last = staged.data() + bucketStart[b + 1];
+            rowEnd.assign(hi - lo + 1, 0);
+            for (Arc *a = first; a != last; ++a)
+                rowEnd[a->source - lo + 1]++;
+            for (int u = lo; u < hi; ++u)
+                rowEnd[u - lo + 1] += rowEnd[u - lo];
+            sorted.resize(last - first);
+            for (Arc *a = first; a != last; ++a)
+                sorted[rowEnd[a->source - lo]++] = *a;
+
+            Arc *out = first;
+            size_t begin = 0;
+            for (int u = lo; u < hi; ++u)
+            {
+                size_t end = rowEnd[u - lo];
+                stableSortShort(sorted.begin() + begin, sorted.begin() + end, [](const Arc &a, const Arc &b)
+                                { return a.target < b.target; });
+                Arc *row = out;
+                for (size_t i = begin; i < end; ++i)
+                    if (!options.dropDuplicates || out == row || out[-1].target != sorted[i].target)
+                        *out++ = sorted[i];
+                offsets[u + 1] = out - row;
+                begin = end;
+            }
+            kept[b] = out - first;
+        } });
+
+    // Pass 4: buckets close up over the dropped arcs, turning degrees into offsets as they are copied out
+    vector<size_t> outStart(bucketCount + 1, 0);
+    for (int b = 0; b < bucketCount; ++b)
+        outStart[b + 1] = outStart[b] + kept[b];
+    vector<vertex_t> targets(outStart[bucketCount]);
+    vector<weight_t> weights(weighted ? outStart[bucketCount] : 0);
+    nextBucket = 0;
+    onThreads(threads, [&](int)
+              {
+        for (int b; (b = nextBucket++) < bucketCount;)
+        {
+            size_t pos = outStart[b];
+            for (int u = min(n, b * bucketSize); u < min(n, (b + 1) * bucketSize); ++u)
+                offsets[u + 1] = pos += offsets[u + 1];
+            const Arc *arcs = staged.data() + bucketStart[b];
+            for (size_t i = 0; i < kept[b]; ++i)
+            {
+                targets[outStart[b] + i] = arcs[i].target;
+                if (weighted)
+                    weights[outStart[b] + i] = arcs[i].weight;
+            }
+        } });
 
+    csrOffsets.swap(offsets);
+    csrTargets.swap(targets);
+    csrWeights.swap(weights);
     return true;
 }
 
-bool Graph::edgeExists(int source, int destination)
+void Graph::packCsrArrays()
 {
-    if (representation == RepresentationType::MATRIX)
-        return matrix[source][destination] != 0;
-    else
+    int n = getVertexCount();
+    PackedRows rows(packedOffsets, packedBytes, PACKED_STRIDE, weighted);
+    rows.bytes.reserve(csrTargets.size() * 2);
+    vector<pair<vertex_t, weight_t>> row;
+    for (int u = 0; u < n; ++u)
     {
-        for (const auto &e : adjacencyList[source])
-            if (e.destination == destination)
-                return true;
-        return false;
+        row.clear();
+        for (int pos = csrOffsets[u]; pos < csrOffsets[u + 1]; ++pos)
+            row.emplace_back(csrTargets[pos], weighted ? csrWeights[pos] : 1);
+        rows.append(u, row);
     }
+    packedBytes.shrink_to_fit();
+    csrOffsets.clear();
+    csrTargets.clear();
+    csrWeights.clear();
 }
 
-float Graph::edgeWeight(int source, int destination) const
+bool Graph::packedFind(int source, int destination, weight_t &weight) const
 {
-    if (representation == RepresentationType::MATRIX)
-        return matrix[source][destination];
-    else
+    // Rows are sorted, so the scan stops at the first larger destination
+    for (const Edge &e : neighbors(source))
     {
-        for (const auto &e : adjacencyList[source])
-            if (e.destination == destination)
-                return e.weight;
-        return 0;
+        if (e.destination == (vertex_t)destination)
+        {
+            weight = e.weight;
+            return true;
+        }
+        if (e.destination > (vertex_t)destination)
+            break;
     }
+    return false;
 }
 
-vector<int> Graph::getNeighbors(int vertex)
+int Graph::csrFind(int source, int destination) const
 {
-    vector<int> neighbors;
-    if (representation == RepresentationType::MATRIX)
+    if (csrOffsets.empty())
+        return -1;
+    auto first = csrTargets.begin() + csrOffsets[source];
+    auto last = csrTargets.begin() + csrOffsets[source + 1];
+    auto it = lower_bound(first, last, (vertex_t)destination);
+    if (it == last || *it != (vertex_t)destination)
+        return -1;
+    return it - csrTargets.begin();
+}
+
+Graph::DeltaRow &Graph::editDelta(int vertex)
+{
+    if (deltaSlot[vertex] == -1)
     {
-        for (size_t i = 0; i < matrix[vertex].size(); i++)
-            if (matrix[vertex][i] != 0)
-                neighbors.push_back(i);
+        deltaSlot[vertex] = deltas.size();
+        deltas.emplace_back();
     }
-    else
+    return deltas[deltaSlot[vertex]];
+}
+
+void Graph::addDeltaArc(int source, int destination, weight_t weight)
+{
+    editDelta(source).added.push_back({(vertex_t)destination, weight});
+    deltaEdits++;
+}
+
+void Graph::eraseDeltaArc(int source, int destination)
+{
+    bool inBase = csrFind(source, destination) != -1;
+    if (!inBase && deltaSlot[source] == -1)
+        return;
+    DeltaRow &row = editDelta(source);
+    row.added.erase(remove_if(row.added.begin(), row.added.end(), [destination](const Edge &e)
+                              { return e.destination == (vertex_t)destination; }),
+                    row.added.end());
+    auto it = lower_bound(row.erased.begin(), row.erased.end(), (vertex_t)destination);
+    if (inBase && (it == row.erased.end() || *it != (vertex_t)destination))
     {
-        for (const auto &e : adjacencyList[vertex])
-            neighbors.push_back(e.destination);
+        row.erased.insert(it, destination);
+        deltaEdits++;
     }
-    return neighbors;
 }
 
-void Graph::printGraph()
+bool Graph::hybridFind(int source, int destination, weight_t &weight) const
 {
-    if (representation == RepresentationType::MATRIX)
+    int pos = csrFind(source, destination);
+    const DeltaRow *row = deltaSlot[source] != -1 ? &deltas[deltaSlot[source]] : nullptr;
+    if (pos != -1 && !(row && binary_search(row->erased.begin(), row->erased.end(), (vertex_t)destination)))
     {
-        cout << "Adjacency Matrix:\n      ";
-        cout << setw(4) << "|";
-        for (size_t i = 0; i < indexToLabel.size(); ++i)
-            cout << setw(4) << indexToLabel[i] << setw(4) << "|";
-        cout << endl;
+        weight = weighted ? csrWeights[pos] : 1;
+        return true;
+    }
+    if (row)
+        for (const Edge &e : row->added)
+            if (e.destination == (vertex_t)destination)
+            {
+                weight = e.weight;
+                return true;
+            }
+    return false;
+}
 
-        cout << string(8, '-') << "-+-";
-        cout << string(8 * indexToLabel.size(), '-') << endl;
+void Graph::mergeIfLarge()
+{
+    if (deltaEdits >= max(MIN_MERGE_EDITS, csrTargets.size() / MERGE_DIVISOR))
+        merge();
+}
 
-        for (size_t i = 0; i < matrix.size(); ++i)
-        {
-            cout << setw(8) << indexToLabel[i];
-            cout << " |";
-            for (float val : matrix[i])
-                cout << setw(4) << val << setw(4) << "|";
-            cout << endl;
-        }
+void Graph::merge()
+{
+    if (representation == RepresentationType::HYBRID && deltaEdits > 0)
+        rebuildBase({});
+}
+
+void Graph::rebuildBase(const vector<tuple<vertex_t, vertex_t, weight_t>> &extra)
+{
+    // Counting sort of the extra arcs by source, mirrored for undirected graphs
+    int n = getVertexCount();
+    vector<size_t> start(n + 1, 0);
+    for (const auto &[u, v, w] : extra)
+    {
+        start[u + 1]++;
+        if (!directed)
+            start[v + 1]++;
     }
-    else
+    for (int i = 0; i < n; ++i)
+        start[i + 1] += start[i];
+    vector<pair<vertex_t, weight_t>> extraArcs(start[n]);
+    vector<size_t> next(start.begin(), start.end() - 1);
+    for (const auto &[u, v, w] : extra)
     {
-        cout << "Adjacency List:\n";
-        cout << "{Origin}({Destination}, {Weight})\n";
-        for (size_t i = 0; i < adjacencyList.size(); i++)
+        extraArcs[next[u]++] = {v, weighted ? w : 1};
+        if (!directed)
+            extraArcs[next[v]++] = {u, weighted ? w : 1};
+    }
+
+    // Untouched rows are copied as they are; rows with edits or extra arcs are re-sorted
+    vector<int> offsets(n + 1, 0);
+    vector<vertex_t> targets;
+    vector<weight_t> weights;
+    size_t arcs = csrTargets.size() + deltaEdits + extraArcs.size();
+    targets.reserve(arcs);
+    if (weighted)
+        weights.reserve(arcs);
+    vector<pair<vertex_t, weight_t>> row;
+    for (int u = 0; u < n; ++u)
+    {
+        row.clear();
+        for (const Edge &e : neighbors(u))
+            row.emplace_back(e.destination, e.weight);
+        row.insert(row.end(), extraArcs.begin() + start[u], extraArcs.begin() + start[u + 1]);
+        if (deltaSlot[u] != -1 || start[u] != start[u + 1])
+            stableSortShort(row.begin(), row.end(), [](const auto &a, const auto &b)
+                            { return a.first < b.first; });
+        for (const auto &[v, w] : row)
         {
-            cout << indexToLabel[i];
-            for (const auto &e : adjacencyList[i])
-                cout << "(" << indexToLabel[e.destination] << ", " << e.weight << ") ";
-            cout << endl;
+            targets.push_back(v);
+            if (weighted)
+                weights.push_back(w);
         }
+        offsets[u + 1] = targets.size();
     }
-    cout << endl;
+
+    csrOffsets.swap(offsets);
+    csrTargets.swap(targets);
+    csrWeights.swap(weights);
+    deltas.clear();
+    deltaSlot.assign(n, -1);
+    deltaEdits = 0;
 }
 
-int Graph::getVertexCount()
+Graph Graph::convertTo(RepresentationType target) const
 {
-    return indexToLabel.size();
+    // Built as directed so each stored arc is copied exactly once
+    Graph converted(true, weighted, target, indexEdges);
+    converted.reserve(getVertexCount());
+    converted.labels = labels;
+    for (int v = 0; v < getVertexCount(); ++v)
+        converted.appendVertexStorage();
+    converted.removed = removed;
+    converted.removedCount = removedCount;
+    // Every stored arc is copied, not only the positive ones getEdges() reports
+    for (int u = 0; u < getVertexCount(); ++u)
+    {
+        if (removed[u])
+            continue;
+        for (const Edge &e : neighbors(u))
+            converted.addEdge(u, e.destination, e.weight);
+    }
+    converted.directed = directed;
+    converted.finalize();
+    return converted;
 }
 
-int Graph::getVertexIndex(string label)
+// Binary graph files: this header, then the CSR offsets, targets and weights (none when unweighted) and
+// the label table, each section starting on a 64-byte boundary so the arrays can be used where they are
+// mapped. Values are stored in the writer's byte order and types, which a reader must share.
+struct BinaryHeader
 {
-    return labelToIndex[label];
-}
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint8_t offsetBytes;
+    uint8_t vertexBytes;
+    uint8_t weightBytes;
+    uint8_t weightIsFloat;
+    uint8_t directed;
+    uint8_t weighted;
+    // IDENTITY_LABELS: none stored. NUMBERED_LABELS: one int per vertex (VertexLabels::numbering).
+    // NAMED_LABELS: V + 1 uint64 start positions, then the label characters back to back.
+    uint8_t labelKind;
+    uint8_t unused = 0;
+    uint64_t vertices;
+    uint64_t arcs;
+    uint64_t offsetsAt;
+    uint64_t targetsAt;
+    uint64_t weightsAt;
+    uint64_t labelsAt;
+    uint64_t labelsBytes;
+};
 
-string Graph::getVertexLabel(int index)
+static const char BINARY_MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N'};
+static const uint32_t BINARY_VERSION = 1;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint64_t BINARY_ALIGNMENT = 64;
+enum : uint8_t
 {
-    return indexToLabel[index];
-}
+    IDENTITY_LABELS,
+    NUMBERED_LABELS,
+    NAMED_LABELS
+};
 
-bool Graph::isWeighted() const
+static uint64_t alignedPosition(uint64_t position)
 {
-    return weighted;
+    return (position + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
 }
 
-Graph Graph::copy() const
+bool Graph::isBinaryFile(const char *begin, const char *end)
 {
-    Graph new_graph(directed, weighted, representation);
-    for (const auto &label : indexToLabel)
-        new_graph.addVertex(label);
+    return (size_t)(end - begin) >= sizeof(BINARY_MAGIC) && memcmp(begin, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
 
-    if (representation == RepresentationType::MATRIX)
+bool Graph::saveBinary(const string &filename) const
+{
+    // Only finalized CSR arrays without tombstones are written as they are
+    if (representation != RepresentationType::CSR || !frozen || removedCount > 0)
     {
-        new_graph.matrix = matrix;
+        Graph csr = convertTo(RepresentationType::CSR);
+        csr.compact();
+        return csr.saveBinary(filename);
     }
+
+    int n = getVertexCount();
+    const int noArcs = 0;
+    const int *offsets = csrOffsets.empty() ? &noArcs : csrOffsets.data();
+    BinaryHeader header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.offsetBytes = sizeof(int);
+    header.vertexBytes = sizeof(vertex_t);
+    header.weightBytes = sizeof(weight_t);
+    header.weightIsFloat = is_floating_point_v<weight_t>;
+    header.directed = directed;
+    header.weighted = weighted;
+    header.vertices = n;
+    header.arcs = offsets[n];
+
+    // Label table
+    vector<uint64_t> labelStarts;
+    string labelChars;
+    if (labels->identity)
+        header.labelKind = labels->numbering.empty() ? IDENTITY_LABELS : NUMBERED_LABELS;
     else
     {
-        new_graph.adjacencyList = adjacencyList;
+        header.labelKind = NAMED_LABELS;
+        labelStarts.push_back(0);
+        for (const string &label : labels->indexToLabel)
+        {
+            labelChars += label;
+            labelStarts.push_back(labelChars.size());
+        }
     }
-    return new_graph;
-}
+    size_t numberedBytes = header.labelKind == NUMBERED_LABELS ? n * sizeof(int) : 0;
+    size_t startBytes = labelStarts.size() * sizeof(uint64_t);
 
-float Graph::getCapacity(int u, int v) const
-{
-    return edgeWeight(u, v);
+    header.offsetsAt = alignedPosition(sizeof(BinaryHeader));
+    header.targetsAt = alignedPosition(header.offsetsAt + (n + 1) * sizeof(int));
+    header.weightsAt = alignedPosition(header.targetsAt + header.arcs * sizeof(vertex_t));
+    header.labelsAt = alignedPosition(header.weightsAt + (weighted ? header.arcs * sizeof(weight_t) : 0));
+    header.labelsBytes = numberedBytes + startBytes + labelChars.size();
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    auto section = [&out](uint64_t position, const void *bytes, size_t count)
+    {
+        static const char padding[BINARY_ALIGNMENT] = {};
+        if (out)
+            out.write(padding, position - out.tellp());
+        out.write(static_cast<const char *>(bytes), count);
+    };
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    section(header.offsetsAt, offsets, (n + 1) * sizeof(int));
+    section(header.targetsAt, csrTargets.data(), header.arcs * sizeof(vertex_t));
+    if (weighted)
+        section(header.weightsAt, csrWeights.data(), header.arcs * sizeof(weight_t));
+    section(header.labelsAt, labels->numbering.data(), numberedBytes);
+    out.write(reinterpret_cast<const char *>(labelStarts.data()), startBytes);
+    out.write(labelChars.data(), labelChars.size());
+    out.close();
+    return !out.fail();
 }
 
-void Graph::addFlow(int u, int v, float delta)
+Graph *Graph::openBinary(shared_ptr<const FileContents> file, bool indexEdges, string &error, bool verifyTargets)
 {
-    if (representation == RepresentationType::MATRIX)
+    const char *begin = file->begin();
+    uint64_t size = file->end() - begin;
+    BinaryHeader header;
+    if (!isBinaryFile(file->begin(), file->end()))
     {
-        matrix[u][v] += delta;
+        error = "not a binary graph file";
+        return nullptr;
     }
-    else
+    if (size < sizeof(header))
+    {
+        error = "the binary graph file is truncated or corrupt";
+        return nullptr;
+    }
+    memcpy(&header, begin, sizeof(header));
+    if (header.version != BINARY_VERSION)
+    {
+        error = "unsupported binary graph version " + to_string(header.version);
+        return nullptr;
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK || header.offsetBytes != sizeof(int) ||
+        header.vertexBytes != sizeof(vertex_t) || header.weightBytes != sizeof(weight_t) ||
+        header.weightIsFloat != is_floating_point_v<weight_t>)
+    {
+        error = "the file was written with another byte order or other vertex/weight types than this build's";
+        return nullptr;
+    }
+
+    // A section must lie inside the file and start aligned for its elements
+    auto fits = [size](uint64_t position, uint64_t bytes)
+    { return position % BINARY_ALIGNMENT == 0 && position <= size && bytes <= size - position; };
+    uint64_t n = header.vertices;
+    uint64_t arcs = header.arcs;
+    if (n >= (uint64_t)INT_MAX || arcs > (uint64_t)INT_MAX || !fits(header.offsetsAt, (n + 1) * sizeof(int)) ||
+        !fits(header.targetsAt, arcs * sizeof(vertex_t)) ||
+        (header.weighted && !fits(header.weightsAt, arcs * sizeof(weight_t))) || !fits(header.labelsAt, header.labelsBytes))
+    {
+        error = "the binary graph file is truncated or corrupt";
+        return nullptr;
+    }
+
+    // Every row must lie inside the targets. Checking that every target is a vertex reads them all, the
+    // only O(E) step, so it is left to callers that ask for it or are about to read every arc anyway.
+    const int *offsets = reinterpret_cast<const int *>(begin + header.offsetsAt);
+    const vertex_t *targets = reinterpret_cast<const vertex_t *>(begin + header.targetsAt);
+    bool rowsValid = offsets[0] == 0 && (uint64_t)offsets[n] == arcs;
+    for (uint64_t v = 0; v < n && rowsValid; ++v)
+        rowsValid = offsets[v] <= offsets[v + 1];
+    for (uint64_t i = 0; verifyTargets && i < arcs && rowsValid; ++i)
+        rowsValid = (uint64_t)(make_unsigned_t<vertex_t>)targets[i] < n;
+
+    Graph *graph = new Graph(header.directed, header.weighted, RepresentationType::CSR, indexEdges);
+    const char *labelBytes = begin + header.labelsAt;
+    VertexLabels &names = *graph->labels;
+    bool labelsValid = true;
+    if (header.labelKind == NUMBERED_LABELS && header.labelsBytes == n * sizeof(int))
     {
-        for (auto &e : adjacencyList[u])
+        const int *numbers = reinterpret_cast<const int *>(labelBytes);
+        int largest = -1;
+        for (uint64_t v = 0; v < n && labelsValid; ++v)
+        {
+            labelsValid = numbers[v] >= 0 && numbers[v] < INT_MAX;
+            largest = max(largest, numbers[v]);
+        }
+        // position[] spans every number up to the largest, so numbers far sparser than a compact() of the
+        // written graph could leave (or corrupt ones) are kept as explicit labels instead, in O(V) memory
+        if (labelsValid && (uint64_t)largest < 16 * n + 1024)
         {
-            if (e.destination == v)
+            names.numbering.assign(numbers, numbers + n);
+            names.position.assign(largest + 1, -1);
+            for (uint64_t v = 0; v < n && labelsValid; ++v)
             {
-                e.weight += delta;
-                return;
+                labelsValid = names.position[numbers[v]] == -1;
+                names.position[numbers[v]] = v;
             }
         }
-        // Se não existir, cria uma nova
-        adjacencyList[u].push_back({v, delta});
-    }
-}
-
-vector<tuple<int, int, float>> Graph::getEdges() const
-{
-    vector<tuple<int, int, float>> edges;
-    if (representation == RepresentationType::MATRIX)
-    {
-        for (size_t u = 0; u < matrix.size(); ++u)
+        else if (labelsValid)
         {
-            for (size_t v = 0; v < matrix[u].size(); ++v)
+            names.identity = false;
+            names.labelToIndex.reserve(n);
+            for (uint64_t v = 0; v < n && labelsValid; ++v)
             {
-                if (matrix[u][v] > 0)
-                    edges.emplace_back(u, v, matrix[u][v]);
+                names.indexToLabel.push_back(to_string(numbers[v]));
+                labelsValid = names.labelToIndex.emplace(names.indexToLabel.back(), v).second;
             }
         }
     }
-    else
+    else if (header.labelKind == NAMED_LABELS && header.labelsBytes >= (n + 1) * sizeof(uint64_t))
     {
-        for (size_t u = 0; u < adjacencyList.size(); ++u)
+        const uint64_t *starts = reinterpret_cast<const uint64_t *>(labelBytes);
+        const char *chars = labelBytes + (n + 1) * sizeof(uint64_t);
+        uint64_t charCount = header.labelsBytes - (n + 1) * sizeof(uint64_t);
+        names.identity = false;
+        names.labelToIndex.reserve(n);
+        labelsValid = starts[0] == 0 && starts[n] == charCount;
+        for (uint64_t v = 0; v < n && labelsValid; ++v)
         {
-            for (const auto &e : adjacencyList[u])
+            labelsValid = starts[v] <= starts[v + 1] && starts[v + 1] <= charCount;
+            if (labelsValid)
             {
-                if (e.weight > 0)
-                    edges.emplace_back(u, e.destination, e.weight);
+                names.indexToLabel.emplace_back(chars + starts[v], starts[v + 1] - starts[v]);
+                labelsValid = names.labelToIndex.emplace(names.indexToLabel.back(), v).second;
             }
         }
     }
-    return edges;
+    else
+        labelsValid = header.labelKind == IDENTITY_LABELS && header.labelsBytes == 0;
+    if (!rowsValid || !labelsValid)
+    {
+        delete graph;
+        error = "the binary graph file is truncated or corrupt";
+        return nullptr;
+    }
+
+    graph->removed.assign(n, 0);
+    graph->csrOffsets.view(file, offsets, n + 1);
+    graph->csrTargets.view(file, targets, arcs);
+    if (graph->weighted)
+        graph->csrWeights.view(file, reinterpret_cast<const weight_t *>(begin + header.weightsAt), arcs);
+    graph->frozen = true;
+    return graph;
+}
+
+const weight_t *Graph::matrixRow(int vertex) const
+{
+    return matrix.data() + (size_t)vertex * matrixStride;
+}
+
+const uint64_t *Graph::bitRow(int vertex) const
+{
+    return bitMatrix.data() + (size_t)vertex * bitWords;
+}
+
+int Graph::bitRowWords() const
+{
+    return bitWords;
 }
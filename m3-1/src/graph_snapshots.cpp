@@ -0,0 +1,100 @@
+#include "graph_snapshots.hpp"
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+GraphSnapshots::GraphSnapshots(Graph initial, int maxReaders)
+    : slots(new Slot[max(1, maxReaders)]), slotCount(max(1, maxReaders)), current(new Graph(move(initial)))
+{
+}
+
+GraphSnapshots::~GraphSnapshots()
+{
+    delete current.load();
+    for (const Graph *graph : retired)
+        delete graph;
+}
+
+GraphSnapshots::Pin::Pin(Pin &&other) noexcept : slot(other.slot), graph(other.graph)
+{
+    other.slot = nullptr;
+    other.graph = nullptr;
+}
+
+GraphSnapshots::Pin::~Pin()
+{
+    if (!slot)
+        return;
+    slot->hazard.store(nullptr, memory_order_release);
+    slot->claimed.store(false, memory_order_release);
+}
+
+GraphSnapshots::Pin GraphSnapshots::pin() const
+{
+    // Each thread starts looking where its last pin found a free slot, so steady readers rarely collide
+    thread_local int hint = 0;
+    Slot *slot = nullptr;
+    for (int i = hint % slotCount;; i = (i + 1) % slotCount)
+    {
+        bool expected = false;
+        if (!slots[i].claimed.load(memory_order_relaxed) &&
+            slots[i].claimed.compare_exchange_strong(expected, true, memory_order_acquire))
+        {
+            slot = &slots[i];
+            hint = i;
+            break;
+        }
+        if (i == (hint + slotCount - 1) % slotCount)
+            this_thread::yield();
+    }
+
+    // Announce the version, then check it is still current: if so, publish() had not replaced it
+    // before the announcement, and a later reclaim() will see it (both sides are sequentially consistent)
+    const Graph *graph = current.load();
+    while (true)
+    {
+        slot->hazard.store(graph);
+        const Graph *again = current.load();
+        if (again == graph)
+            break;
+        graph = again;
+    }
+    return Pin(slot, graph);
+}
+
+const Graph &GraphSnapshots::latest() const
+{
+    return *current.load(memory_order_relaxed);
+}
+
+Graph GraphSnapshots::draft() const
+{
+    return latest().copy();
+}
+
+void GraphSnapshots::publish(Graph next)
+{
+    retired.push_back(current.exchange(new Graph(move(next))));
+    reclaim();
+}
+
+size_t GraphSnapshots::retiredCount() const
+{
+    return retired.size();
+}
+
+void GraphSnapshots::reclaim()
+{
+    vector<const Graph *> pinned;
+    for (int i = 0; i < slotCount; ++i)
+        if (const Graph *graph = slots[i].hazard.load())
+            pinned.push_back(graph);
+    sort(pinned.begin(), pinned.end());
+
+    auto kept = partition(retired.begin(), retired.end(), [&](const Graph *graph)
+                          { return binary_search(pinned.begin(), pinned.end(), graph); });
+    for (auto it = kept; it != retired.end(); ++it)
+        delete *it;
+    retired.erase(kept, retired.end());
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <charconv>
 
 #include "graph.hpp"
 #include "utils.hpp"
@@ -23,12 +24,14 @@ void printColoringResult(string name, pair<int, vector<int>> &result, Graph &g)
         cout << "Vertex colors:\n";
         for (int i = 0; i < result.second.size(); ++i)
         {
+            if (g.isRemoved(i))
+                continue;
             cout << g.getVertexLabel(i) << ": Color " << result.second[i] << endl;
         }
     }
 }
 
-void printAGMResult(const string &name, const pair<int, vector<tuple<int, int, int>>> &result)
+void printAGMResult(const string &name, const pair<weight_t, vector<tuple<weight_t, int, int>>> &result, Graph &g)
 {
 
     if (result.second.size() <= 20)
@@ -36,7 +39,7 @@ void printAGMResult(const string &name, const pair<int, vector<tuple<int, int, i
         cout << "Arestas da AGM:" << endl;
         for (const auto &[w, u, v] : result.second)
         {
-            cout << u << " - " << v << " (peso: " << w << ")\n";
+            cout << g.getVertexLabel(u) << " - " << g.getVertexLabel(v) << " (peso: " << w << ")\n";
         }
     }
 
@@ -44,6 +47,36 @@ void printAGMResult(const string &name, const pair<int, vector<tuple<int, int, i
     cout << "Peso total: " << result.first << endl;
 }
 
+string formatBytes(size_t bytes)
+{
+    ostringstream out;
+    out << fixed << setprecision(1);
+    if (bytes < 1024)
+        out << bytes << " B";
+    else if (bytes < 1024 * 1024)
+        out << bytes / 1024.0 << " KiB";
+    else if (bytes < 1024 * 1024 * 1024)
+        out << bytes / (1024.0 * 1024) << " MiB";
+    else
+        out << bytes / (1024.0 * 1024 * 1024) << " GiB";
+    return out.str();
+}
+
+string representationName(RepresentationType type)
+{
+    if (type == RepresentationType::MATRIX)
+        return "MATRIX";
+    if (type == RepresentationType::CSR)
+        return "CSR";
+    if (type == RepresentationType::BITMATRIX)
+        return "BITMATRIX";
+    if (type == RepresentationType::COMPRESSED)
+        return "COMPRESSED";
+    if (type == RepresentationType::HYBRID)
+        return "HYBRID";
+    return "LIST";
+}
+
 // Function to format duration in a human-readable way
 string formatDuration(long long nanoseconds)
 {
@@ -86,7 +119,7 @@ int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        cerr << "Usage: " << argv[0] << " <graph_file> [LIST|MATRIX]\n";
+        cerr << "Usage: " << argv[0] << " <graph_file> [LIST|MATRIX|CSR|BITMATRIX|COMPRESSED|HYBRID|AUTO] [INDEXED] [RCM|DEGREE|BFS|DFS] [BUDGET=<MiB>] [SAVE=<file>] [VERIFY]\n";
         return 1;
     }
 
@@ -102,20 +135,124 @@ int main(int argc, char *argv[])
         {
             type = RepresentationType::MATRIX;
         }
+        else if (mode == "CSR")
+        {
+            type = RepresentationType::CSR;
+        }
+        else if (mode == "BITMATRIX")
+        {
+            type = RepresentationType::BITMATRIX;
+        }
+        else if (mode == "COMPRESSED")
+        {
+            type = RepresentationType::COMPRESSED;
+        }
+        else if (mode == "HYBRID")
+        {
+            type = RepresentationType::HYBRID;
+        }
+        else if (mode == "AUTO")
+        {
+            type = RepresentationType::AUTO;
+        }
         else if (mode != "LIST")
         {
-            cerr << "Invalid representation type. Use LIST or MATRIX.\n";
+            cerr << "Invalid representation type. Use LIST, MATRIX, CSR, BITMATRIX, COMPRESSED, HYBRID or AUTO.\n";
+            return 1;
+        }
+    }
+
+    // INDEXED adds an O(1) edge lookup index to LIST graphs; a strategy name renumbers the vertices after loading;
+    // BUDGET=<MiB> caps the estimated graph size (and steers AUTO away from matrices that would exceed it);
+    // SAVE=<file> writes the loaded (and reordered) graph as a binary file that later runs open instantly;
+    // VERIFY checks every edge target of such a file opened in place, which reads the whole file
+    bool indexEdges = false;
+    bool verifyBinary = false;
+    size_t memoryBudget = 0;
+    string saveFile;
+    bool reorder = false;
+    ReorderStrategy strategy = ReorderStrategy::RCM;
+    for (int i = 3; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (option == "INDEXED")
+        {
+            indexEdges = true;
+            continue;
+        }
+        if (option.rfind("BUDGET=", 0) == 0)
+        {
+            size_t megabytes = 0;
+            auto [end, error] = from_chars(option.data() + 7, option.data() + option.size(), megabytes);
+            if (error != errc() || end != option.data() + option.size() || megabytes == 0)
+            {
+                cerr << "Invalid memory budget: " << option << ". Use BUDGET=<MiB>, for example BUDGET=512.\n";
+                return 1;
+            }
+            memoryBudget = megabytes << 20;
+            continue;
+        }
+        if (option == "VERIFY")
+        {
+            verifyBinary = true;
+            continue;
+        }
+        if (option.rfind("SAVE=", 0) == 0 && option.size() > 5)
+        {
+            saveFile = option.substr(5);
+            continue;
+        }
+
+        reorder = true;
+        if (option == "RCM")
+            strategy = ReorderStrategy::RCM;
+        else if (option == "DEGREE")
+            strategy = ReorderStrategy::DEGREE;
+        else if (option == "BFS")
+            strategy = ReorderStrategy::BFS;
+        else if (option == "DFS")
+            strategy = ReorderStrategy::DFS;
+        else
+        {
+            cerr << "Invalid option: " << option << ". Use INDEXED, RCM, DEGREE, BFS, DFS, BUDGET=<MiB>, SAVE=<file> or VERIFY.\n";
             return 1;
         }
     }
 
-    Graph *g = loadGraphFromFile(filename, type);
+    Graph *g = loadGraphFromFile(filename, type, indexEdges, memoryBudget, verifyBinary);
     if (!g)
     {
         cerr << "Failed to load graph.\n";
         return 1;
     }
 
+    MemoryFootprint footprint = g->memoryFootprint();
+    cout << "\nINFO: Representation " << representationName(g->getRepresentation())
+         << (type == RepresentationType::AUTO ? " (AUTO)" : "") << ", memory " << formatBytes(footprint.total())
+         << " (structure " << formatBytes(footprint.structure) << ", labels " << formatBytes(footprint.labels)
+         << ", weights " << formatBytes(footprint.weights) << ")" << endl;
+
+    if (reorder)
+    {
+        // Labels move with their vertices, so every result below is still reported in the file's labels
+        cout << "\nINFO: Reordering vertices" << endl;
+        auto start = chrono::high_resolution_clock::now();
+        g->reorder(strategy);
+        auto end = chrono::high_resolution_clock::now();
+        cout << "Execution time: " << formatDuration(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+    }
+
+    if (!saveFile.empty())
+    {
+        cout << "\nINFO: Saving binary graph to " << saveFile << endl;
+        if (!g->saveBinary(saveFile))
+        {
+            cerr << "Error writing binary graph file: " << saveFile << endl;
+            delete g;
+            return 1;
+        }
+    }
+
     g->printGraph();
 
     // --- AGM with Prim ---
@@ -123,7 +260,7 @@ int main(int argc, char *argv[])
     auto start = chrono::high_resolution_clock::now();
     auto primResult = prim_mst(*g);
     auto end = chrono::high_resolution_clock::now();
-    printAGMResult("Prim", primResult);
+    printAGMResult("Prim", primResult, *g);
     cout << "Execution time: " << formatDuration(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
 
     // --- AGM with Kruskal ---
@@ -131,7 +268,7 @@ int main(int argc, char *argv[])
     start = chrono::high_resolution_clock::now();
     auto kruskalResult = kruskal_mst(*g);
     end = chrono::high_resolution_clock::now();
-    printAGMResult("Kruskal", kruskalResult);
+    printAGMResult("Kruskal", kruskalResult, *g);
     cout << "Execution time: " << formatDuration(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
 
     delete g;
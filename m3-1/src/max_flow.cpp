@@ -10,74 +10,123 @@
 using namespace std;
 
 // BEGIN: Depth-First Search (DFS) utility functions
-bool dfsUtil(Graph &graph, int v, int goal, std::vector<bool> &visited, std::vector<int> &parent)
+// Residual arcs are numbered 2 * id, along edge `id` with capacity[id] - flow[id] left, and 2 * id + 1,
+// against it, able to cancel up to flow[id]
+static bool dfsUtil(const EdgeTable &network, const vector<weight_t> &flow, int v, int goal, vector<bool> &visited, vector<int> &parentArc)
 {
     visited[v] = true;
     if (v == goal)
         return true;
 
-    for (int neighbor : graph.getNeighbors(v))
+    for (int id = network.firstEdge(v); id < network.firstEdge(v + 1); ++id)
     {
-        float capacity = graph.edgeWeight(v, neighbor);
-        if (!visited[neighbor] && capacity > 0)
+        int neighbor = network.target(id);
+        if (!visited[neighbor] && network.capacity[id] - flow[id] > 0)
         {
-            parent[neighbor] = v;
-            if (dfsUtil(graph, neighbor, goal, visited, parent))
+            parentArc[neighbor] = 2 * id;
+            if (dfsUtil(network, flow, neighbor, goal, visited, parentArc))
+                return true;
+        }
+    }
+    for (const int *id = network.inEdgesBegin(v); id != network.inEdgesEnd(v); ++id)
+    {
+        int neighbor = network.source(*id);
+        if (!visited[neighbor] && flow[*id] > 0)
+        {
+            parentArc[neighbor] = 2 * *id + 1;
+            if (dfsUtil(network, flow, neighbor, goal, visited, parentArc))
                 return true;
         }
     }
     return false;
 }
 
-bool dfs(Graph &graph, int start, int goal, std::vector<bool> &visited, std::vector<int> &parent)
+// Vertices flagged in `blocked` start out visited, so the search never enters them
+static bool dfs(const EdgeTable &network, const vector<weight_t> &flow, int start, int goal, const vector<bool> &blocked,
+                vector<bool> &visited, vector<int> &parentArc)
 {
-    visited.assign(graph.getVertexCount(), false);
-    parent.assign(graph.getVertexCount(), -1);
-    return dfsUtil(graph, start, goal, visited, parent);
+    visited = blocked;
+    parentArc.assign(network.getVertexCount(), -1);
+    return dfsUtil(network, flow, start, goal, visited, parentArc);
 }
 // END: Depth-First Search (DFS) utility functions
 
-int fordFulkerson(Graph original, int source, int destination)
+// Vertices with a path of positive capacity to `sink`, found by a backward BFS over the in-edges
+static vector<bool> reachesSink(const EdgeTable &network, int sink)
 {
-    Graph residual = original.copy();
-    int max_flow = 0;
-    vector<int> parent(residual.getVertexCount());
+    vector<bool> reached(network.getVertexCount(), false);
+    vector<int> queue = {sink};
+    reached[sink] = true;
+    for (size_t head = 0; head < queue.size(); ++head)
+        for (const int *id = network.inEdgesBegin(queue[head]); id != network.inEdgesEnd(queue[head]); ++id)
+            if (!reached[network.source(*id)] && network.capacity[*id] > 0)
+            {
+                reached[network.source(*id)] = true;
+                queue.push_back(network.source(*id));
+            }
+    return reached;
+}
+
+pair<weight_t, vector<weight_t>> fordFulkersonFlows(const EdgeTable &network, int source, int destination)
+{
+    vector<weight_t> flow = network.newColumn<weight_t>();
+    weight_t max_flow = 0;
+    vector<int> parentArc;
+
+    // Sink-side pruning: flow only runs along paths into the sink, so every residual arc leaving a vertex
+    // that cannot reach the sink in the original graph leads to another such vertex. Searches skip them all.
+    vector<bool> blocked = reachesSink(network, destination);
+    if (source == destination || !blocked[source])
+        return {0, flow};
+    blocked.flip();
+
+    // The tail of a residual arc: the edge's source going along it, its target going against it
+    auto tail = [&](int arc)
+    { return arc % 2 ? network.target(arc / 2) : network.source(arc / 2); };
 
     while (true)
     {
-        vector<bool> visited(residual.getVertexCount(), false);
-        fill(parent.begin(), parent.end(), -1);
+        vector<bool> visited;
 
-        if (!dfs(residual, source, destination, visited, parent))
+        if (!dfs(network, flow, source, destination, blocked, visited, parentArc))
             break;
 
-        float path_flow = numeric_limits<float>::max();
-        for (int v = destination; v != source; v = parent[v])
+        weight_t path_flow = numeric_limits<weight_t>::max();
+        for (int v = destination; v != source; v = tail(parentArc[v]))
         {
-            int u = parent[v];
-            path_flow = min(path_flow, residual.getCapacity(u, v));
+            int arc = parentArc[v];
+            path_flow = min(path_flow, arc % 2 ? flow[arc / 2] : network.capacity[arc / 2] - flow[arc / 2]);
         }
 
-        for (int v = destination; v != source; v = parent[v])
+        for (int v = destination; v != source; v = tail(parentArc[v]))
         {
-            int u = parent[v];
-            residual.addFlow(u, v, -path_flow);
-            residual.addFlow(v, u, path_flow);
+            int arc = parentArc[v];
+            flow[arc / 2] += arc % 2 ? -path_flow : path_flow;
         }
 
         max_flow += path_flow;
     }
 
-    return max_flow;
+    return {max_flow, flow};
+}
+
+weight_t fordFulkerson(const Graph &original, int source, int destination)
+{
+    // Capacities and flows live in edge-id columns, so the graph itself is only read, once
+    return fordFulkersonFlows(EdgeTable(original), source, destination).first;
 }
 
-int localSearch(Graph &graph, int source, int destination, int iterations)
+weight_t localSearch(Graph &graph, int source, int destination, int iterations)
 {
     srand(static_cast<unsigned>(time(nullptr)));
 
-    int original_flow = fordFulkerson(graph, source, destination);
-    int best_flow = original_flow; // Initialize best flow with the original flow
-    Graph best_graph = graph;
+    weight_t original_flow = fordFulkerson(graph, source, destination);
+    weight_t best_flow = original_flow; // Initialize best flow with the original flow
+    // Edges are flipped in place with their capacities, so CSR and BITMATRIX graphs are searched as a list
+    RepresentationType type = graph.getRepresentation();
+    Graph best_graph = type == RepresentationType::MATRIX || type == RepresentationType::LIST
+                           ? graph
+                           : graph.convertTo(RepresentationType::LIST);
     // Generate random number based on a seed
     mt19937 rng(random_device{}());
 
@@ -88,6 +137,7 @@ int localSearch(Graph &graph, int source, int destination, int iterations)
 
     for (int i = 0; i < iterations; ++i)
     {
+        // Shares all rows with best_graph except the two the flip below touches
         Graph neighbor = best_graph;
         auto edges = neighbor.getEdges();
         if (edges.empty())
@@ -99,7 +149,7 @@ int localSearch(Graph &graph, int source, int destination, int iterations)
         neighbor.removeEdge(u, v);
         neighbor.addEdge(v, u, c); // Invert the edge direction
 
-        int new_flow = fordFulkerson(neighbor, source, destination);
+        weight_t new_flow = fordFulkerson(neighbor, source, destination);
         steps++; // Increment the step count
 
         if (new_flow > best_flow)
@@ -1,13 +1,14 @@
 #include "nav_algorithms.hpp"
+#include "basic_graph.hpp"
 #include <iostream>
 #include <queue>
 #include <limits>
 
-void bfs(Graph &graph, const std::string &startLabel)
+// Traversals run on the compile-time specialised view; the Graph facade only resolves labels.
+template <typename G>
+static std::vector<int> bfsOrder(const G &graph, int start)
 {
-    std::cout << "\n[BFS] Visiting from: " << startLabel << std::endl;
-
-    int start = graph.getVertexIndex(startLabel);
+    std::vector<int> order;
     std::vector<bool> visited(graph.getVertexCount(), false);
     std::list<int> queue;
 
@@ -18,56 +19,74 @@ void bfs(Graph &graph, const std::string &startLabel)
     {
         int v = queue.front();
         queue.pop_front();
-        std::cout << graph.getVertexLabel(v) << " ";
+        order.push_back(v);
 
-        for (int neighbor : graph.getNeighbors(v))
-        {
+        graph.forEachNeighbor(v, [&](int neighbor, weight_t)
+                              {
             if (!visited[neighbor])
             {
                 visited[neighbor] = true;
                 queue.push_back(neighbor);
-            }
-        }
+            } });
     }
-    std::cout << std::endl;
+    return order;
 }
 
-void dfsUtil(Graph &graph, int v, std::vector<bool> &visited)
+template <typename G>
+static void dfsVisit(const G &graph, int v, std::vector<bool> &visited, std::vector<int> &order)
 {
     visited[v] = true;
-    std::cout << graph.getVertexLabel(v) << " ";
+    order.push_back(v);
 
-    for (int neighbor : graph.getNeighbors(v))
-    {
+    graph.forEachNeighbor(v, [&](int neighbor, weight_t)
+                          {
         if (!visited[neighbor])
-            dfsUtil(graph, neighbor, visited);
-    }
+            dfsVisit(graph, neighbor, visited, order); });
 }
 
-void dfs(Graph &graph, const std::string &startLabel)
+void bfs(const Graph &graph, const std::string &startLabel)
 {
-    std::cout << "\n[DFS] Visiting from: " << startLabel << std::endl;
+    std::cout << "\n[BFS] Visiting from: " << startLabel << std::endl;
 
     int start = graph.getVertexIndex(startLabel);
-    std::vector<bool> visited(graph.getVertexCount(), false);
-    dfsUtil(graph, start, visited);
+    if (start == -1)
+    {
+        std::cout << "[BFS] Warning: vertex " << startLabel << " not found.\n";
+        return;
+    }
+    std::vector<int> order = visitGraph(graph, [&](const auto &view)
+                                        { return bfsOrder(view, start); });
+    for (int v : order)
+        std::cout << graph.getVertexLabel(v) << " ";
     std::cout << std::endl;
 }
 
-void dijkstra(Graph &graph, const std::string &startLabel)
+void dfs(const Graph &graph, const std::string &startLabel)
 {
-    if (!graph.isWeighted())
+    std::cout << "\n[DFS] Visiting from: " << startLabel << std::endl;
+
+    int start = graph.getVertexIndex(startLabel);
+    if (start == -1)
     {
-        std::cout << "\n[Dijkstra] Warning: Graph is not weighted. Skipping Dijkstra.\n";
+        std::cout << "[DFS] Warning: vertex " << startLabel << " not found.\n";
         return;
     }
+    std::vector<int> order = visitGraph(graph, [&](const auto &view)
+                                        {
+        std::vector<bool> visited(view.getVertexCount(), false);
+        std::vector<int> visitOrder;
+        dfsVisit(view, start, visited, visitOrder);
+        return visitOrder; });
+    for (int v : order)
+        std::cout << graph.getVertexLabel(v) << " ";
+    std::cout << std::endl;
+}
 
-    int V = graph.getVertexCount();
-    int start = graph.getVertexIndex(startLabel);
-
-    std::vector<float> dist(V, std::numeric_limits<float>::infinity());
-    std::vector<int> prev(V, -1);
-    std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>, std::greater<>> pq;
+// Fills dist/prev with the shortest-path tree from `start`
+template <typename G>
+static void shortestPaths(const G &graph, int start, std::vector<weight_t> &dist, std::vector<int> &prev)
+{
+    std::priority_queue<std::pair<weight_t, int>, std::vector<std::pair<weight_t, int>>, std::greater<>> pq;
 
     dist[start] = 0;
     pq.push({0, start});
@@ -77,23 +96,48 @@ void dijkstra(Graph &graph, const std::string &startLabel)
         int u = pq.top().second;
         pq.pop();
 
-        for (int v : graph.getNeighbors(u))
-        {
-            float weight = graph.edgeWeight(u, v);
+        graph.forEachNeighbor(u, [&](int v, weight_t weight)
+                              {
             if (dist[u] + weight < dist[v])
             {
                 dist[v] = dist[u] + weight;
                 prev[v] = u;
                 pq.push({dist[v], v});
-            }
-        }
+            } });
+    }
+}
+
+void dijkstra(const Graph &graph, const std::string &startLabel)
+{
+    if (!graph.isWeighted())
+    {
+        std::cout << "\n[Dijkstra] Warning: Graph is not weighted. Skipping Dijkstra.\n";
+        return;
+    }
+
+    int V = graph.getVertexCount();
+    int start = graph.getVertexIndex(startLabel);
+    if (start == -1)
+    {
+        std::cout << "\n[Dijkstra] Warning: vertex " << startLabel << " not found. Skipping Dijkstra.\n";
+        return;
     }
 
+    // Integer weight types have no infinity, so they mark unreachable vertices with their largest value
+    const weight_t unreachable = std::numeric_limits<weight_t>::has_infinity ? std::numeric_limits<weight_t>::infinity()
+                                                                             : std::numeric_limits<weight_t>::max();
+    std::vector<weight_t> dist(V, unreachable);
+    std::vector<int> prev(V, -1);
+    visitGraph(graph, [&](const auto &view)
+               { shortestPaths(view, start, dist, prev); });
+
     std::cout << "\n[Dijkstra] Shortest distances from " << startLabel << ":\n";
     for (int i = 0; i < V; ++i)
     {
+        if (graph.isRemoved(i))
+            continue;
         std::cout << "To " << graph.getVertexLabel(i) << " [" << i << "]: ";
-        if (dist[i] == std::numeric_limits<float>::infinity())
+        if (dist[i] == unreachable)
         {
             std::cout << "unreachable\n";
             continue;
@@ -1,69 +1,574 @@
 #include "utils.hpp"
-#include <fstream>
-#include <sstream>
+#include "file_contents.hpp"
+#include "threads.hpp"
+#include <algorithm>
 #include <iostream>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <climits>
+#include <type_traits>
 
 using namespace std;
 
-Graph *loadGraphFromFile(const string &filename, RepresentationType reprType)
+// Whitespace as `>>` skips it, minus the newline that ends each line
+static bool isBlank(char c)
 {
-    ifstream file(filename);
-    if (!file.is_open())
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// The next blank-separated token of the line [cursor, lineEnd), empty once the line is used up
+static string_view nextToken(const char *&cursor, const char *lineEnd)
+{
+    while (cursor < lineEnd && isBlank(*cursor))
+        ++cursor;
+    const char *start = cursor;
+    while (cursor < lineEnd && !isBlank(*cursor))
+        ++cursor;
+    return string_view(start, cursor - start);
+}
+
+// Reads a number from the start of `token` like `>>` would (a leading '+' allowed, trailing text ignored)
+template <typename T>
+static bool parseNumber(string_view token, T &value)
+{
+    if (!token.empty() && token[0] == '+')
+        token.remove_prefix(1);
+    return !token.empty() && from_chars(token.data(), token.data() + token.size(), value).ec == errc();
+}
+
+// Text formats the loader reads. NATIVE is this project's "V A D P" header followed by one
+// "source destination [weight]" line per edge. The others are the usual benchmark formats: DIMACS
+// ("p edge V E" with "e u v" lines, or "p max V A" with "a u v capacity" lines), METIS (an
+// "n m [fmt [ncon]]" header, then line v lists v's neighbours), Matrix Market coordinate files and
+// SNAP edge lists ("u<TAB>v" lines under '#' comments).
+enum class TextFormat
+{
+    NATIVE,
+    DIMACS,
+    METIS,
+    MATRIX_MARKET,
+    SNAP
+};
+
+// What the header of a text file says, and how its edge lines are read
+struct EdgeLayout
+{
+    TextFormat format = TextFormat::NATIVE;
+    int vertices = 0;
+    // Edges the header announces, -1 for none (SNAP files have no header)
+    long long edges = -1;
+    bool directed = true;
+    bool weighted = false;
+    // Number of the first vertex in the file, 0 or 1
+    int base = 0;
+    // DIMACS: the letter of edge lines, 'e' or 'a'
+    char edgeTag = 'e';
+    // METIS: numbers before each neighbour list (vertex size and weights), skipped
+    int skippedFields = 0;
+    // Matrix Market skew-symmetric: entry (i, j, w) also stands for (j, i, -w), added as a second arc
+    bool negatedMirror = false;
+    // Lines before the first edge line, so errors can give file line numbers
+    size_t headerLines = 0;
+};
+
+// The edges of one newline-aligned slice of the file, and the first bad line in it if any
+struct ParsedChunk
+{
+    enum Problem
     {
-        cerr << "Error opening file: " << filename << endl;
-        return nullptr;
+        NONE,
+        MALFORMED,
+        MISSING_WEIGHT,
+        UNKNOWN_VERTEX
+    };
+
+    // METIS sources are the vertex line's index within the chunk until streamEdges offsets them
+    vector<tuple<vertex_t, vertex_t, weight_t>> edges;
+    // Lines parsed, the bad one excluded
+    size_t lines = 0;
+    // METIS: vertex lines parsed
+    size_t rows = 0;
+    Problem problem = NONE;
+    string_view badLine;
+};
+
+// Vertex index of a numeric token, which must be a whole number between base and base + vertices - 1
+static bool parseVertex(string_view token, const EdgeLayout &layout, int &index)
+{
+    long long number;
+    const char *last = token.data() + token.size();
+    auto [end, error] = from_chars(token.data(), last, number);
+    if (token.empty() || error != errc() || end != last || number < layout.base || number - layout.base >= layout.vertices)
+        return false;
+    index = number - layout.base;
+    return true;
+}
+
+// Reads one line's edges into the chunk. The native format names vertices by label, the others by number.
+static ParsedChunk::Problem parseLine(const char *lineStart, const char *lineEnd, const Graph &graph,
+                                      const EdgeLayout &layout, ParsedChunk &chunk)
+{
+    const char *field = lineStart;
+    string_view first = nextToken(field, lineEnd);
+    weight_t weight = 1;
+    int u = -1, v = -1;
+
+    if (layout.format == TextFormat::NATIVE)
+    {
+        string_view destination = nextToken(field, lineEnd);
+        if (destination.empty())
+            return ParsedChunk::MALFORMED;
+        if (layout.weighted && !parseNumber(nextToken(field, lineEnd), weight))
+            return ParsedChunk::MISSING_WEIGHT;
+        // The vertices carry numeric labels, so this parses the token rather than hashing it
+        if ((u = graph.getVertexIndex(first)) == -1 || (v = graph.getVertexIndex(destination)) == -1)
+            return ParsedChunk::UNKNOWN_VERTEX;
+        chunk.edges.emplace_back(u, v, weight);
+        return ParsedChunk::NONE;
     }
 
-    int V, A, D, P;
-    string headerLine;
-    getline(file, headerLine);
-    stringstream ss(headerLine);
-    if (!(ss >> V >> A >> D >> P))
+    if (layout.format == TextFormat::METIS)
     {
-        cerr << "Error: invalid header format. Expected: V A D P\n";
-        return nullptr;
+        if (!first.empty() && first[0] == '%')
+            return ParsedChunk::NONE;
+        int row = chunk.rows++;
+        field = lineStart;
+        for (int skip = 0; skip < layout.skippedFields; ++skip)
+            if (nextToken(field, lineEnd).empty())
+                return ParsedChunk::MALFORMED;
+        for (string_view token; !(token = nextToken(field, lineEnd)).empty();)
+        {
+            if (!parseVertex(token, layout, v))
+                return ParsedChunk::UNKNOWN_VERTEX;
+            if (layout.weighted && !parseNumber(nextToken(field, lineEnd), weight))
+                return ParsedChunk::MISSING_WEIGHT;
+            chunk.edges.emplace_back(row, v, weight);
+        }
+        return ParsedChunk::NONE;
     }
 
-    Graph *graph = new Graph(D == 1, P == 1, reprType);
+    // One edge per line, after a leading tag in DIMACS; blank and comment lines hold none
+    char comment = layout.format == TextFormat::DIMACS ? 'c' : layout.format == TextFormat::MATRIX_MARKET ? '%' : '#';
+    if (first.empty() || first[0] == comment)
+        return ParsedChunk::NONE;
+    if (layout.format == TextFormat::DIMACS)
+    {
+        // Node designators ("n id s|t") name a flow problem's terminals, which callers choose themselves
+        if (first == "n")
+            return ParsedChunk::NONE;
+        if (first.size() != 1 || first[0] != layout.edgeTag)
+            return ParsedChunk::MALFORMED;
+        first = nextToken(field, lineEnd);
+    }
+    string_view second = nextToken(field, lineEnd);
+    if (second.empty())
+        return ParsedChunk::MALFORMED;
+    if (layout.weighted && !parseNumber(nextToken(field, lineEnd), weight))
+        return ParsedChunk::MISSING_WEIGHT;
+    if (!parseVertex(first, layout, u) || !parseVertex(second, layout, v))
+        return ParsedChunk::UNKNOWN_VERTEX;
+    chunk.edges.emplace_back(u, v, weight);
+    if (layout.negatedMirror)
+        chunk.edges.emplace_back(v, u, -weight);
+    return ParsedChunk::NONE;
+}
 
-    for (int i = 0; i < V; ++i)
-        graph->addVertex(to_string(i));
+// Parses the lines of [cursor, end) until a bad line or `maxEdges` edges (any after those are not edges of
+// the graph). Only reads the graph, so chunks can be parsed concurrently.
+static void parseChunk(const char *cursor, const char *end, const Graph &graph, const EdgeLayout &layout,
+                       size_t maxEdges, ParsedChunk &chunk)
+{
+    while (cursor < end && chunk.edges.size() < maxEdges)
+    {
+        const char *lineStart = cursor;
+        const char *lineEnd = static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+        if (!lineEnd)
+            lineEnd = end;
+        cursor = lineEnd == end ? end : lineEnd + 1;
+        ParsedChunk::Problem problem = parseLine(lineStart, lineEnd, graph, layout, chunk);
+        if (problem != ParsedChunk::NONE)
+        {
+            chunk.problem = problem;
+            chunk.badLine = string_view(lineStart, lineEnd - lineStart);
+            return;
+        }
+        chunk.lines++;
+    }
+}
 
-    string line;
-    int edgeCount = 0;
-    while (getline(file, line) && edgeCount < A)
+// Bytes of edge lines each thread parses per round, which bounds the loader's scratch memory
+static const size_t SLICE_BYTES = 4 << 20;
+
+// Parses the edge lines in [cursor, end) and hands them to `sink` in file order, in rounds: each thread
+// parses its own newline-aligned slice of about SLICE_BYTES, then the round's batches are passed on, so
+// scratch memory depends on the thread count, not on the file. Stops after `maxEdges` edges. On a bad
+// line among them, reports it with its line number and returns false.
+static bool streamEdges(const char *cursor, const char *end, const Graph &graph, const EdgeLayout &layout,
+                        int maxEdges, const EdgeSink &sink, int &edgeCount)
+{
+    int threads = (int)max<size_t>(1, min<size_t>(thread::hardware_concurrency(), (end - cursor) >> 20));
+    vector<ParsedChunk> chunks(threads);
+    vector<const char *> bounds(threads + 1);
+    size_t line = layout.headerLines;
+    size_t row = 0;
+    edgeCount = 0;
+    while (cursor < end && edgeCount < maxEdges)
     {
-        string source, destination;
-        float weight = 1.0;
+        bounds[0] = cursor;
+        for (int t = 1; t <= threads; ++t)
+        {
+            const char *split = bounds[t - 1] + min<size_t>(SLICE_BYTES, end - bounds[t - 1]);
+            const char *newline = split < end ? static_cast<const char *>(memchr(split, '\n', end - split)) : nullptr;
+            bounds[t] = newline ? newline + 1 : end;
+        }
+        size_t remaining = maxEdges - edgeCount;
+        onThreads(threads, [&](int t)
+                  {
+            chunks[t].edges.clear();
+            chunks[t].lines = chunks[t].rows = 0;
+            chunks[t].problem = ParsedChunk::NONE;
+            parseChunk(bounds[t], bounds[t + 1], graph, layout, remaining, chunks[t]); });
 
-        stringstream ss(line);
-        if (!(ss >> source >> destination))
+        // The chunks' line and row counts place each chunk in the file
+        for (ParsedChunk &chunk : chunks)
         {
-            cerr << "Error reading edge line: '" << line << "'\n";
-            delete graph;
-            return nullptr;
+            if (chunk.problem != ParsedChunk::NONE && edgeCount + chunk.edges.size() < (size_t)maxEdges)
+            {
+                size_t number = line + chunk.lines + 1;
+                if (chunk.problem == ParsedChunk::MALFORMED)
+                    cerr << "Error reading edge line " << number << ": '" << chunk.badLine << "'\n";
+                else if (chunk.problem == ParsedChunk::MISSING_WEIGHT)
+                    cerr << "Error: edge weight expected but missing in line " << number << ": '" << chunk.badLine << "'\n";
+                else
+                    cerr << "Error: unknown vertex in line " << number << ": '" << chunk.badLine << "'\n";
+                return false;
+            }
+            if (layout.format == TextFormat::METIS)
+            {
+                // Every edge is listed by both endpoints; the lower one's line keeps it
+                size_t kept = 0;
+                for (auto &[u, v, w] : chunk.edges)
+                {
+                    if (row + u >= (size_t)layout.vertices)
+                    {
+                        cerr << "Error: more vertex lines than the " << layout.vertices << " vertices in the header\n";
+                        return false;
+                    }
+                    if ((u += row) < v)
+                        chunk.edges[kept++] = {u, v, w};
+                }
+                chunk.edges.resize(kept);
+                row += chunk.rows;
+            }
+            line += chunk.lines;
+            chunk.edges.resize(min<size_t>(chunk.edges.size(), maxEdges - edgeCount));
+            edgeCount += chunk.edges.size();
+            if (!chunk.edges.empty())
+                sink(chunk.edges);
         }
+        cursor = bounds[threads];
+    }
+    return true;
+}
 
-        if (P == 1 && !(ss >> weight))
+// Splits off the line at `cursor`, moving past it
+static string_view takeLine(const char *&cursor, const char *end)
+{
+    const char *newline = static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+    const char *lineEnd = newline ? newline : end;
+    string_view line(cursor, lineEnd - cursor);
+    cursor = newline ? newline + 1 : end;
+    return line;
+}
+
+// Lowercase copy of a header keyword
+static string lowercase(string_view token)
+{
+    string lower(token);
+    for (char &c : lower)
+        c = tolower((unsigned char)c);
+    return lower;
+}
+
+static bool endsWith(const string &text, const string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Recognises the format from the first line (and the file name, for METIS files, whose header looks like
+// a native one) and reads the header, leaving `cursor` on the first edge line. SNAP files have no header,
+// so their vertices are counted by a first pass over the edges.
+static bool readHeader(const string &filename, const char *&cursor, const char *end, EdgeLayout &layout)
+{
+    const char *start = cursor;
+    string_view firstLine = takeLine(cursor, end);
+    const char *field = firstLine.data();
+    const char *firstEnd = field + firstLine.size();
+    string_view first = nextToken(field, firstEnd);
+    cursor = start;
+    auto nextLine = [&](char comment)
+    {
+        // Skips blank and comment lines, counting every line passed
+        while (cursor < end)
         {
-            cerr << "Error: edge weight expected but missing in line: '" << line << "'\n";
-            delete graph;
-            return nullptr;
+            string_view line = takeLine(cursor, end);
+            layout.headerLines++;
+            const char *at = line.data();
+            string_view token = nextToken(at, line.data() + line.size());
+            if (!token.empty() && token[0] != comment)
+                return line;
         }
+        return string_view();
+    };
+    auto numbers = [](string_view line, auto &...values)
+    {
+        const char *at = line.data();
+        const char *lineEnd = at + line.size();
+        return (parseNumber(nextToken(at, lineEnd), values) && ...);
+    };
 
-        if (!graph->addEdge(graph->getVertexIndex(source), graph->getVertexIndex(destination), weight))
+    if (first.rfind("%%MatrixMarket", 0) == 0)
+    {
+        layout.format = TextFormat::MATRIX_MARKET;
+        string_view banner = takeLine(cursor, end);
+        layout.headerLines++;
+        const char *at = banner.data();
+        const char *bannerEnd = banner.data() + banner.size();
+        nextToken(at, bannerEnd);
+        string object = lowercase(nextToken(at, bannerEnd));
+        string storage = lowercase(nextToken(at, bannerEnd));
+        string field = lowercase(nextToken(at, bannerEnd));
+        string symmetry = lowercase(nextToken(at, bannerEnd));
+        if (object != "matrix" || storage != "coordinate" ||
+            (field != "real" && field != "double" && field != "integer" && field != "pattern") ||
+            (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric") ||
+            (symmetry == "skew-symmetric" && (field == "pattern" || !is_signed_v<weight_t>)))
         {
-            cerr << "Error adding edge: " << source << " -> " << destination << endl;
-            delete graph;
-            return nullptr;
+            cerr << "Error: unsupported Matrix Market file; expected a real, integer or pattern coordinate matrix\n";
+            return false;
         }
+        long long rows, columns;
+        if (!numbers(nextLine('%'), rows, columns, layout.edges) || rows < 0 || columns < 0 || max(rows, columns) >= INT_MAX)
+        {
+            cerr << "Error: invalid Matrix Market size line. Expected: rows columns entries\n";
+            return false;
+        }
+        layout.vertices = max(rows, columns);
+        // A skew-symmetric matrix mirrors each entry with the opposite sign, which an undirected graph
+        // cannot hold, so it is read as a directed one with both arcs
+        layout.directed = symmetry != "symmetric";
+        layout.negatedMirror = symmetry == "skew-symmetric";
+        layout.weighted = field != "pattern";
+        layout.base = 1;
+        return true;
+    }
+
+    if (endsWith(filename, ".graph") || endsWith(filename, ".metis") || (!first.empty() && first[0] == '%'))
+    {
+        layout.format = TextFormat::METIS;
+        string_view header = nextLine('%');
+        const char *at = header.data();
+        const char *headerEnd = at + header.size();
+        bool counts = parseNumber(nextToken(at, headerEnd), layout.vertices) && parseNumber(nextToken(at, headerEnd), layout.edges);
+        string_view fmt = nextToken(at, headerEnd);
+        string_view ncon = nextToken(at, headerEnd);
+        int conditions = 1;
+        if (!counts || layout.vertices < 0 || fmt.size() > 3 || fmt.find_first_not_of("01") != string_view::npos ||
+            (!ncon.empty() && (!parseNumber(ncon, conditions) || conditions < 0)))
+        {
+            cerr << "Error: invalid METIS header format. Expected: n m [fmt [ncon]]\n";
+            return false;
+        }
+        // fmt digits, right to left: edge weights, vertex weights, vertex sizes
+        auto flag = [fmt](size_t digit)
+        { return fmt.size() > digit && fmt[fmt.size() - 1 - digit] == '1'; };
+        layout.weighted = flag(0);
+        layout.skippedFields = (flag(1) ? conditions : 0) + (flag(2) ? 1 : 0);
+        layout.directed = false;
+        layout.base = 1;
+        return true;
+    }
+
+    if (first == "c" || first == "p")
+    {
+        layout.format = TextFormat::DIMACS;
+        string_view problem = nextLine('c');
+        const char *at = problem.data();
+        const char *problemEnd = at + problem.size();
+        string_view tag = nextToken(at, problemEnd);
+        string kind = lowercase(nextToken(at, problemEnd));
+        if (tag != "p" || !parseNumber(nextToken(at, problemEnd), layout.vertices) ||
+            !parseNumber(nextToken(at, problemEnd), layout.edges) || layout.vertices < 0)
+        {
+            cerr << "Error: invalid DIMACS problem line. Expected: p <edge|col|max|sp> vertices edges\n";
+            return false;
+        }
+        if (kind == "edge" || kind == "col")
+            layout.directed = layout.weighted = false;
+        else if (kind == "max" || kind == "sp")
+        {
+            layout.directed = layout.weighted = true;
+            layout.edgeTag = 'a';
+        }
+        else
+        {
+            cerr << "Error: unsupported DIMACS problem '" << kind << "'; expected edge, col, max or sp\n";
+            return false;
+        }
+        layout.base = 1;
+        return true;
+    }
+
+    // A line of four numbers is a native header even when its counts are out of range
+    int D, P;
+    bool nativeHeader = numbers(firstLine, layout.vertices, layout.edges, D, P);
+    if (nativeHeader && layout.vertices >= 0 && layout.edges <= INT_MAX)
+    {
+        takeLine(cursor, end);
+        layout.headerLines = 1;
+        layout.directed = D == 1;
+        layout.weighted = P == 1;
+        return true;
+    }
+    if (nativeHeader || ((first.empty() || first[0] != '#') && firstLine.find('\t') == string_view::npos))
+    {
+        cerr << "Error: invalid header format. Expected: V A D P\n";
+        return false;
+    }
+
+    // SNAP: the '#' comments may say the graph is undirected; vertex numbers start at 0 and run up to the
+    // largest one used
+    layout.format = TextFormat::SNAP;
+    for (const char *at = cursor; at < end && *at == '#';)
+        if (takeLine(at, end).find("Undirected") != string_view::npos)
+            layout.directed = false;
+    layout.vertices = INT_MAX;
+    // Only native lines look vertices up in the graph, so an empty one will do
+    Graph none(true, false, RepresentationType::LIST);
+    int largest = -1;
+    int edgeCount = 0;
+    if (!streamEdges(cursor, end, none, layout, INT_MAX, [&largest](const vector<tuple<vertex_t, vertex_t, weight_t>> &batch)
+                     {
+            for (const auto &[u, v, w] : batch)
+                largest = max<int>(largest, max(u, v)); }, edgeCount))
+        return false;
+    layout.vertices = largest + 1;
+    layout.edges = edgeCount;
+    return true;
+}
+
+// A saveBinary() file: CSR (and AUTO) graphs use its arrays in place, other representations are built
+// from them
+static Graph *loadBinaryGraph(shared_ptr<const FileContents> file, RepresentationType reprType, bool indexEdges,
+                              size_t memoryBudget, bool verify)
+{
+    // A conversion reads every arc anyway, so checking the targets first costs little
+    bool inPlace = reprType == RepresentationType::AUTO || reprType == RepresentationType::CSR;
+    string error;
+    Graph *graph = Graph::openBinary(move(file), indexEdges, error, verify || !inPlace);
+    if (!graph)
+    {
+        cerr << "Error: " << error << "\n";
+        return nullptr;
+    }
+    if (inPlace)
+        return graph;
 
-        edgeCount++;
+    size_t arcs = 0;
+    for (int v = 0; v < graph->getVertexCount(); ++v)
+        arcs += graph->getDegree(v);
+    size_t estimate = Graph::estimateFootprint(reprType, graph->getVertexCount(), arcs, graph->isWeighted(), indexEdges);
+    if (memoryBudget > 0 && estimate > memoryBudget)
+    {
+        cerr << "Error: the graph needs about " << (estimate >> 20) << " MiB in this representation, over the memory budget of "
+             << (memoryBudget >> 20) << " MiB\n";
+        delete graph;
+        return nullptr;
     }
+    if (reprType == RepresentationType::BITMATRIX && graph->isWeighted())
+        cerr << "Warning: BITMATRIX stores no weights; edge weights will be ignored\n";
+
+    Graph *converted = new Graph(graph->convertTo(reprType));
+    delete graph;
+    return converted;
+}
+
+Graph *loadGraphFromFile(const string &filename, RepresentationType reprType, bool indexEdges, size_t memoryBudget,
+                         bool verifyBinary)
+{
+    // Parsed in place: no line or label is copied out of the file
+    auto file = make_shared<FileContents>(filename);
+    if (!file->isOpen())
+    {
+        cerr << "Error opening file: " << filename << endl;
+        return nullptr;
+    }
+    if (Graph::isBinaryFile(file->begin(), file->end()))
+        return loadBinaryGraph(move(file), reprType, indexEdges, memoryBudget, verifyBinary);
+    file->adviseSequential();
+
+    const char *cursor = file->begin();
+    const char *end = file->end();
+    EdgeLayout layout;
+    if (!readHeader(filename, cursor, end, layout))
+        return nullptr;
+    int V = layout.vertices;
+    // The native format stops after the A edges its header announces; the others are read to the end
+    int A = max<long long>(0, min<long long>(layout.edges, INT_MAX));
+    int maxEdges = layout.format == TextFormat::NATIVE ? A : INT_MAX;
+
+    size_t arcs = (size_t)A * (layout.directed && !layout.negatedMirror ? 1 : 2);
+    if (reprType == RepresentationType::AUTO)
+        reprType = Graph::chooseRepresentation(V, arcs, layout.weighted, memoryBudget, indexEdges);
+
+    size_t estimate = Graph::estimateFootprint(reprType, V, arcs, layout.weighted, indexEdges);
+    if (memoryBudget > 0 && estimate > memoryBudget)
+    {
+        cerr << "Error: the graph needs about " << (estimate >> 20) << " MiB in this representation, over the memory budget of "
+             << (memoryBudget >> 20) << " MiB\n";
+        return nullptr;
+    }
+
+    if (reprType == RepresentationType::BITMATRIX && layout.weighted)
+        cerr << "Warning: BITMATRIX stores no weights; edge weights will be ignored\n";
+
+    // The frozen representations build their arrays straight from the file, so they need no staging space
+    // for the edges
+    bool buildDirectly = reprType == RepresentationType::CSR || reprType == RepresentationType::COMPRESSED ||
+                         reprType == RepresentationType::HYBRID;
+    Graph *graph = new Graph(layout.directed, layout.weighted, reprType, indexEdges);
+    graph->reserve(V, buildDirectly ? 0 : A);
+
+    for (int i = 0; i < V; ++i)
+        graph->addVertex(to_string(i));
+
+    // Edges are streamed from the file rather than collected first: the frozen representations count them
+    // and then write them straight into their arrays, the others add each batch as it is parsed
+    int edgeCount = 0;
+    auto readEdges = [&](const EdgeSink &sink)
+    { return streamEdges(cursor, end, *graph, layout, maxEdges, sink, edgeCount); };
+    bool parsed = true;
+    bool added = true;
+    if (buildDirectly)
+        added = graph->buildFromStream([&](const EdgeSink &sink)
+                                       { return parsed = readEdges(sink); });
+    else
+        parsed = readEdges([&](const vector<tuple<vertex_t, vertex_t, weight_t>> &batch)
+                           { added = graph->addEdges(batch) && added; });
+    if (!parsed || !added)
+    {
+        if (parsed)
+            cerr << "Error adding edges: an endpoint is not a vertex of the graph\n";
+        delete graph;
+        return nullptr;
+    }
+
+    // A skew-symmetric entry was read as two arcs
+    if (layout.edges >= 0 && edgeCount != layout.edges * (layout.negatedMirror ? 2 : 1))
+        cerr << "Warning: number of edges read (" << edgeCount << ") differs from expected (" << layout.edges << ")\n";
 
-    if (edgeCount != A)
-        cerr << "Warning: number of edges read (" << edgeCount << ") differs from expected (" << A << ")\n";
+    graph->finalize();
 
-    file.close();
     return graph;
 }